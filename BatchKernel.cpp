@@ -0,0 +1,187 @@
+// BatchKernel.cpp - implementation file
+#ifndef BATCHKERNEL_H
+#define BATCHKERNEL_H
+
+#include "Lanes.h"
+#include "Propagator.cpp"
+#include "BatchKernel.h"
+using namespace std;
+
+// Constructor
+BatchKernel::BatchKernel() {
+    Propagator::buildTables();
+    this->fallbacks = 0;
+}
+
+//====loadLane==================================================================
+// Description: Loads one puzzle into a lane
+// Parameters: lane - lane index, puzzle - 81-character line, already checked
+//==============================================================================
+void BatchKernel::loadLane(int lane, const string &puzzle) {
+    for (int cell = 0; cell < 81; cell++) {
+        char c = puzzle[cell];
+        if (c >= '1' && c <= '9') {
+            cand[cell][lane] = 1 << (c - '1');
+            placed[cell][lane] = cand[cell][lane];
+        } else {
+            cand[cell][lane] = 0x1FF;
+            placed[cell][lane] = 0;
+        }
+    }
+    dead[lane] = 0;
+}                         // end of loadLane
+//==============================================================================
+
+//====nakedSweep================================================================
+// Description: For every cell in every lane, removes the numbers placed in
+//              its peers and places the cell if one candidate is left. A
+//              cell left with none (including a clashing given) kills its lane
+// Return: true if any lane changed
+//==============================================================================
+bool BatchKernel::nakedSweep() {
+    LaneVector changed = laneZero();
+    LaneVector deadLanes = laneLoad(dead);
+
+    for (int cell = 0; cell < 81; cell++) {
+        LaneVector used = laneZero();
+        for (int i = 0; i < 20; i++) {
+            used = laneOr(used, laneLoad(placed[Propagator::peers[cell][i]]));
+        }
+
+        LaneVector before = laneLoad(cand[cell]);
+        LaneVector after = laneAndNot(used, before);
+        LaneVector empty = laneIsZero(after);
+        LaneVector single = laneAndNot(empty, laneIsZero(laneAnd(after, laneMinusOne(after))));
+
+        changed = laneOr(changed, laneXor(before, after));
+        deadLanes = laneOr(deadLanes, empty);
+        laneStore(cand[cell], after);
+        laneStore(placed[cell], laneOr(laneLoad(placed[cell]), laneAnd(after, single)));
+    }
+
+    laneStore(dead, deadLanes);
+    return laneAny(laneAndNot(deadLanes, changed));
+}                         // end of nakedSweep
+//==============================================================================
+
+//====hiddenSweep===============================================================
+// Description: For every unit in every lane, a number with one possible cell
+//              becomes that cell's only candidate; a number with none kills
+//              the lane
+// Return: true if any lane changed
+//==============================================================================
+bool BatchKernel::hiddenSweep() {
+    LaneVector changed = laneZero();
+    LaneVector deadLanes = laneLoad(dead);
+    LaneVector all = laneSplat(0x1FF);
+
+    for (int u = 0; u < 27; u++) {
+        LaneVector once = laneZero();
+        LaneVector twice = laneZero();
+        for (int i = 0; i < 9; i++) {
+            LaneVector c = laneLoad(cand[Propagator::units[u][i]]);
+            twice = laneOr(twice, laneAnd(once, c));
+            once = laneOr(once, c);
+        }
+
+        deadLanes = laneOr(deadLanes, laneXor(laneAnd(once, all), all));
+        LaneVector hidden = laneAndNot(twice, once);
+
+        for (int i = 0; i < 9; i++) {
+            int cell = Propagator::units[u][i];
+            LaneVector before = laneLoad(cand[cell]);
+            LaneVector only = laneAnd(before, hidden);
+            LaneVector keep = laneIsZero(only);
+
+            // lanes where this cell holds a hidden single keep just that
+            LaneVector after = laneOr(laneAnd(keep, before), only);
+            changed = laneOr(changed, laneXor(before, after));
+            laneStore(cand[cell], after);
+        }
+    }
+
+    laneStore(dead, deadLanes);
+    return laneAny(laneAndNot(deadLanes, changed));
+}                         // end of hiddenSweep
+//==============================================================================
+
+//====solve=====================================================================
+// Description: Solves up to LANES puzzles together: naked and hidden single
+//              sweeps run over all lanes at once until nothing changes, then
+//              each lane that still has open cells is finished by the scalar
+//              Propagator search
+// Parameters: puzzles - 81-character lines, count - how many (<= LANES),
+//             solutions - receives each solved grid, solved - receives
+//             whether each puzzle was solved
+// Return: number of puzzles solved
+//==============================================================================
+int BatchKernel::solve(const string puzzles[], int count, string solutions[], bool solved[]) {
+    if (count > LANES) {
+        count = LANES;
+    }
+
+    // unused lanes get an empty board and are ignored
+    for (int lane = 0; lane < LANES; lane++) {
+        loadLane(lane, lane < count ? puzzles[lane] : string(81, '.'));
+    }
+
+    bool changed = true;
+    while (changed) {
+        changed = nakedSweep();
+        changed = hiddenSweep() || changed;
+    }
+
+    int total = 0;
+    for (int lane = 0; lane < count; lane++) {
+        solved[lane] = false;
+        if (dead[lane]) {
+            continue;
+        }
+
+        bool complete = true;
+        for (int cell = 0; cell < 81 && complete; cell++) {
+            complete = placed[cell][lane] != 0;
+        }
+
+        if (complete) {
+            solutions[lane].assign(81, '0');
+            for (int cell = 0; cell < 81; cell++) {
+                solutions[lane][cell] = '1' + __builtin_ctz(placed[cell][lane]);
+            }
+            solved[lane] = true;
+            total++;
+            continue;
+        }
+
+        // lane needs branching: finish it with the scalar search
+        fallbacks++;
+        PackedBoard board;
+        board.clear();
+        for (int cell = 0; cell < 81; cell++) {
+            board.cells[cell] = placed[cell][lane] ? __builtin_ctz(placed[cell][lane]) + 1 : 0;
+        }
+
+        Propagator search;
+        if (search.solve(board)) {
+            solutions[lane].assign(81, '0');
+            for (int cell = 0; cell < 81; cell++) {
+                solutions[lane][cell] = '0' + board.cells[cell];
+            }
+            solved[lane] = true;
+            total++;
+        }
+    }
+
+    return total;
+}                         // end of solve
+//==============================================================================
+
+//====getFallbackCount==========================================================
+// Description: Returns how many lanes needed the scalar search so far
+//==============================================================================
+long long BatchKernel::getFallbackCount() {
+    return fallbacks;
+}                         // end of getFallbackCount
+//==============================================================================
+
+#endif
@@ -0,0 +1,26 @@
+// BatchKernel.h - header file
+
+#include <string>
+using namespace std;
+
+class BatchKernel {
+public:
+    static const int LANES = LANE_WIDTH;    // boards propagated together
+
+private:
+    // structure of arrays: one row of LANES masks per cell, one board per lane
+    alignas(32) unsigned short cand[81][LANES];     // candidates
+    alignas(32) unsigned short placed[81][LANES];   // placed number's bit, 0 if empty
+    alignas(32) unsigned short dead[LANES];         // 0xFFFF once a lane has no solution
+
+    long long fallbacks;
+
+    void loadLane(int lane, const string &puzzle);
+    bool nakedSweep();
+    bool hiddenSweep();
+
+public:
+    BatchKernel();
+    int solve(const string puzzles[], int count, string solutions[], bool solved[]);
+    long long getFallbackCount();
+};
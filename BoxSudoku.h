@@ -0,0 +1,310 @@
+// BoxSudoku.h - size-generic solver core
+//     BoxSudoku<BoxR, BoxC>: an N x N board (N = BoxR * BoxC) made of boxes
+//     BoxR rows tall and BoxC columns wide. Templates live in the header;
+//     every size gets its own fully specialized tables and mask type. The
+//     9x9 game's Sudoku class is separate and not templated.
+#ifndef BOXSUDOKU_H
+#define BOXSUDOKU_H
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+using namespace std;
+
+// Row, column, box and peer tables for one board size, built at compile time
+template <int BoxR, int BoxC>
+struct BoxTables {
+    static constexpr int N = BoxR * BoxC;
+    static constexpr int CELLS = N * N;
+    static constexpr int PEERS = 2 * (N - 1) + (BoxR - 1) * (BoxC - 1);
+
+    int row[CELLS];
+    int col[CELLS];
+    int box[CELLS];
+    int units[3 * N][N];            // rows, then columns, then boxes
+    int peers[CELLS][PEERS];
+
+    constexpr BoxTables() : row(), col(), box(), units(), peers() {
+        int filled[3 * N] = {};
+
+        for (int cell = 0; cell < CELLS; cell++) {
+            row[cell] = cell / N;
+            col[cell] = cell % N;
+            box[cell] = (row[cell] / BoxR) * (N / BoxC) + col[cell] / BoxC;
+
+            units[row[cell]][filled[row[cell]]++] = cell;
+            units[N + col[cell]][filled[N + col[cell]]++] = cell;
+            units[2 * N + box[cell]][filled[2 * N + box[cell]]++] = cell;
+        }
+
+        for (int cell = 0; cell < CELLS; cell++) {
+            int count = 0;
+            for (int other = 0; other < CELLS; other++) {
+                bool shared = row[other] == row[cell] || col[other] == col[cell] || box[other] == box[cell];
+                if (other != cell && shared) {
+                    peers[cell][count++] = other;
+                }
+            }
+        }
+    }
+};
+
+template <int BoxR, int BoxC>
+class BoxSudoku {
+public:
+    static constexpr int N = BoxR * BoxC;
+    static constexpr int CELLS = N * N;
+
+    // uint16 masks up to 16x16, uint32 above (25x25)
+    typedef typename conditional<(N <= 16), uint16_t, uint32_t>::type Mask;
+    static constexpr Mask ALL = (Mask) ((1ull << N) - 1);
+
+private:
+    static constexpr BoxTables<BoxR, BoxC> tables{};
+
+    uint8_t cells[CELLS];           // 0 for empty, 1-N otherwise
+    uint8_t solution[CELLS];
+    Mask rowMask[N];
+    Mask colMask[N];
+    Mask boxMask[N];
+    bool recordSolution;
+    long long nodes;
+
+    //====candidates============================================================
+    // Description: Returns the numbers that can legally go in a cell
+    //==========================================================================
+    Mask candidates(int cell) const {
+        return ~(rowMask[tables.row[cell]] | colMask[tables.col[cell]] | boxMask[tables.box[cell]]) & ALL;
+    }
+
+    //====place / clear=========================================================
+    // Description: Writes or erases a number and keeps the masks in step
+    //==========================================================================
+    void place(int cell, int num) {
+        Mask bit = (Mask) 1 << (num - 1);
+        cells[cell] = num;
+        rowMask[tables.row[cell]] |= bit;
+        colMask[tables.col[cell]] |= bit;
+        boxMask[tables.box[cell]] |= bit;
+    }
+
+    void clear(int cell) {
+        Mask bit = ~((Mask) 1 << (cells[cell] - 1));
+        cells[cell] = 0;
+        rowMask[tables.row[cell]] &= bit;
+        colMask[tables.col[cell]] &= bit;
+        boxMask[tables.box[cell]] &= bit;
+    }
+
+    //====hiddenSingle==========================================================
+    // Description: Looks for a number that fits in only one cell of a unit
+    // Parameters: cell - set to that cell, open - set to that number's bit
+    // Return: 1 if one was found, 0 if none, -1 if some unit has a number
+    //         with nowhere to go
+    //==========================================================================
+    int hiddenSingle(int &cell, Mask &open) const {
+        for (int u = 0; u < 3 * N; u++) {
+            Mask once = 0;
+            Mask twice = 0;
+            Mask placed = 0;
+
+            for (int i = 0; i < N; i++) {
+                int c = tables.units[u][i];
+                if (cells[c] != 0) {
+                    placed |= (Mask) 1 << (cells[c] - 1);
+                } else {
+                    Mask cand = candidates(c);
+                    twice |= once & cand;
+                    once |= cand;
+                }
+            }
+
+            if ((once | placed) != ALL) {
+                return -1;
+            }
+
+            Mask single = once & ~twice & ~placed;
+            if (single) {
+                open = single & (Mask) -single;
+                for (int i = 0; i < N; i++) {
+                    int c = tables.units[u][i];
+                    if (cells[c] == 0 && (candidates(c) & open)) {
+                        cell = c;
+                        return 1;
+                    }
+                }
+            }
+        }
+
+        return 0;
+    }
+
+    //====search================================================================
+    // Description: Counts solutions. Branches on a hidden single if there is
+    //              one, otherwise on the empty cell with the fewest candidates
+    // Parameters: limit - stop once this many are found (0 counts them all)
+    //==========================================================================
+    int search(int limit) {
+        int best = -1;
+        int bestCount = N + 1;
+        Mask open = 0;
+
+        for (int cell = 0; cell < CELLS; cell++) {
+            if (cells[cell] != 0) {
+                continue;
+            }
+
+            Mask cand = candidates(cell);
+            int count = __builtin_popcount(cand);
+            if (count == 0) {
+                return 0;
+            }
+            if (count < bestCount) {
+                best = cell;
+                bestCount = count;
+                open = cand;
+                if (count == 1) {
+                    break;
+                }
+            }
+        }
+
+        // no naked single: a hidden single is just as forced
+        if (bestCount > 1 && best >= 0) {
+            int found = hiddenSingle(best, open);
+            if (found < 0) {
+                return 0;
+            }
+        }
+
+        // no empty cells: solved
+        if (best < 0) {
+            if (recordSolution) {
+                for (int cell = 0; cell < CELLS; cell++) {
+                    solution[cell] = cells[cell];
+                }
+                recordSolution = false;
+            }
+            return 1;
+        }
+
+        int solutions = 0;
+        while (open) {
+            int num = __builtin_ctz(open) + 1;
+            open &= open - 1;
+
+            place(best, num);
+            nodes++;
+            solutions += search(limit ? limit - solutions : 0);
+            clear(best);
+
+            if (limit && solutions >= limit) {
+                break;
+            }
+        }
+
+        return solutions;
+    }
+
+public:
+    BoxSudoku() : cells(), solution(), rowMask(), colMask(), boxMask(), recordSolution(false), nodes(0) {}
+
+    //====load==================================================================
+    // Description: Loads a puzzle, row by row, one character per cell: '.'
+    //              or '0' for empty, '1'-'9' then 'A', 'B', ... for 10 and up
+    // Return: true if the line is a consistent puzzle of this size
+    //==========================================================================
+    bool load(const string &line) {
+        if ((int) line.size() < CELLS) {
+            return false;
+        }
+
+        for (int i = 0; i < N; i++) {
+            rowMask[i] = 0;
+            colMask[i] = 0;
+            boxMask[i] = 0;
+        }
+
+        for (int cell = 0; cell < CELLS; cell++) {
+            char c = line[cell];
+            int num = 0;
+            if (c >= '1' && c <= '9') {
+                num = c - '0';
+            } else if (c >= 'A' && c <= 'Z') {
+                num = c - 'A' + 10;
+            } else if (c >= 'a' && c <= 'z') {
+                num = c - 'a' + 10;
+            } else if (c != '.' && c != '0') {
+                return false;
+            }
+
+            cells[cell] = 0;
+            if (num > N || (num && !(candidates(cell) & ((Mask) 1 << (num - 1))))) {
+                return false;
+            }
+            if (num) {
+                place(cell, num);
+            }
+        }
+
+        return true;
+    }
+
+    //====toString==============================================================
+    // Description: Returns the board in the same format load reads
+    //==========================================================================
+    string toString() const {
+        string line(CELLS, '.');
+        for (int cell = 0; cell < CELLS; cell++) {
+            int num = cells[cell];
+            if (num) {
+                line[cell] = num <= 9 ? '0' + num : 'A' + num - 10;
+            }
+        }
+        return line;
+    }
+
+    //====count=================================================================
+    // Description: Counts the solutions of the board, stopping at limit
+    //==========================================================================
+    int count(int limit = 0) {
+        nodes = 0;
+        return search(limit);
+    }
+
+    //====solve=================================================================
+    // Description: Fills in the board with its first solution
+    // Return: true if the board was solved, false if it has no solution
+    //==========================================================================
+    bool solve() {
+        recordSolution = true;
+        if (count(1) == 0) {
+            recordSolution = false;
+            return false;
+        }
+
+        for (int cell = 0; cell < CELLS; cell++) {
+            if (cells[cell] == 0) {
+                place(cell, solution[cell]);
+            }
+        }
+        return true;
+    }
+
+    int get(int x, int y) const {
+        return cells[x * N + y];
+    }
+
+    long long getNodeCount() const {
+        return nodes;
+    }
+};
+
+typedef BoxSudoku<2, 2> Sudoku4x4;
+typedef BoxSudoku<2, 3> Sudoku6x6;
+typedef BoxSudoku<3, 3> Sudoku9x9;
+typedef BoxSudoku<3, 4> Sudoku12x12;
+typedef BoxSudoku<4, 4> Sudoku16x16;
+typedef BoxSudoku<5, 5> Sudoku25x25;
+
+#endif // BOXSUDOKU_H
@@ -0,0 +1,523 @@
+// Canonical.cpp - implementation file
+#ifndef CANONICAL_H
+#define CANONICAL_H
+
+#include "PackedBoard.h"
+#include "Canonical.h"
+#include <algorithm>
+using namespace std;
+
+//====labelCell=================================================================
+// Description: Relabels a source digit, handing out the next free result
+//              digit the first time it is seen. Blanks stay 0
+// Parameters: cand - transform being built, num - source digit
+// Return: result digit
+//==============================================================================
+static inline int labelCell(CanonCandidate &cand, int num) {
+    if (num == 0) {
+        return 0;
+    }
+    if (cand.label[num] == 0) {
+        cand.label[num] = cand.nextLabel++;
+    }
+    return cand.label[num];
+}                         // end of labelCell
+//==============================================================================
+
+//====fitStack==================================================================
+// Description: Puts a source stack at a result stack if neither is placed
+//              yet and the stack has as many clues in the first row as the
+//              result stack needs
+// Parameters: search - search state, state - candidate to update, stack -
+//             source stack, slot - result stack
+// Return: true if the stack was placed
+//==============================================================================
+static bool fitStack(const CanonSearch &search, CanonCandidate &state, int stack, int slot) {
+    const unsigned char *cell = search.grid[state.transposed] + state.rowOrder[0] * 9 + stack * 3;
+
+    if (state.slotStack[slot] != 3 || state.stackSlot[stack] != 3) {
+        return false;
+    }
+    if ((cell[0] != 0) + (cell[1] != 0) + (cell[2] != 0) != search.slotClues[slot]) {
+        return false;
+    }
+    state.slotStack[slot] = stack;
+    state.stackSlot[stack] = slot;
+    return true;
+}                         // end of fitStack
+//==============================================================================
+
+//====placeColumn===============================================================
+// Description: Puts a source column at a free result column if the first
+//              row's blank layout and the stack order allow it, and labels
+//              the column's clue in the first row after its position
+// Parameters: search - search state, state - candidate to update, col -
+//             source column, pos - result column
+// Return: true if the column was placed
+//==============================================================================
+static bool placeColumn(const CanonSearch &search, CanonCandidate &state, int col, int pos) {
+    const unsigned char *first = search.grid[state.transposed] + state.rowOrder[0] * 9;
+    int slot = pos / 3;
+
+    if (state.posOf[col] != 9 || state.colOrder[pos] != 9) {
+        return false;
+    }
+    if ((first[col] == 0) != (search.rank[pos] == 0)) {
+        return false;
+    }
+    if (state.slotStack[slot] != col / 3 && !fitStack(search, state, col / 3, slot)) {
+        return false;
+    }
+
+    state.colOrder[pos] = col;
+    state.posOf[col] = pos;
+    if (first[col]) {
+        state.label[first[col]] = search.rank[pos];
+    }
+    return true;
+}                         // end of placeColumn
+//==============================================================================
+
+//====cellValue=================================================================
+// Description: Relabels a cell of the row being searched. A digit whose
+//              first-row column isn't placed yet takes the earliest result
+//              column left for it: a later one only gives this cell a larger
+//              digit
+// Parameters: search - search state, state - candidate to update, row -
+//             source row, col - source column of the cell
+// Return: result digit, or -1 if the digit's column can't be placed
+//==============================================================================
+static int cellValue(const CanonSearch &search, CanonCandidate &state, const unsigned char *row, int col) {
+    const unsigned char *first = search.grid[state.transposed] + state.rowOrder[0] * 9;
+    int num = row[col];
+
+    if (num == 0 || state.label[num] != 0) {
+        return num == 0 ? 0 : state.label[num];
+    }
+    if (!(search.digits[state.transposed][state.rowOrder[0]] & (1 << num))) {
+        return labelCell(state, num);
+    }
+    for (int source = 0; source < 9; source++) {
+        if (first[source] != num) {
+            continue;
+        }
+        // clues of the first row sit after the blanks of their stack
+        for (int slot = 0; slot < 3; slot++) {
+            if (state.slotStack[slot] != source / 3 && state.slotStack[slot] != 3) {
+                continue;
+            }
+            for (int pos = slot * 3 + 3 - search.slotClues[slot]; pos < slot * 3 + 3; pos++) {
+                if (state.colOrder[pos] == 9) {
+                    if (placeColumn(search, state, source, pos)) {
+                        return state.label[num];
+                    }
+                    break;
+                }
+            }
+        }
+        return -1;
+    }
+    return labelCell(state, num);
+}                         // end of cellValue
+//==============================================================================
+
+//====keepCell==================================================================
+// Description: Compares a cell with the best row so far, past the prefix the
+//              branch shares with it. A smaller cell makes a new best and
+//              drops the candidates tied for the old one
+// Parameters: search - search state, pos - result column, num - result digit
+// Return: true if the branch still ties for the best row
+//==============================================================================
+static inline bool keepCell(CanonSearch &search, int pos, int num) {
+    if (num < 0) {
+        return false;
+    }
+    if (search.bestLen > pos) {
+        if (num > search.best[pos]) {
+            return false;
+        }
+        if (num < search.best[pos]) {
+            search.found->clear();
+            search.bestLen = pos;
+        }
+    }
+    if (search.bestLen <= pos) {
+        search.best[pos] = num;
+        search.bestLen = pos + 1;
+    }
+    return true;
+}                         // end of keepCell
+//==============================================================================
+
+//====searchRow=================================================================
+// Description: Reads a source row as the next result row, placing free
+//              columns one result column at a time and keeping every
+//              placement that ties for the smallest row. Free columns that
+//              are blank in this row too stay free together, blanks first in
+//              their stack, so their order is left to a later row
+// Parameters: search - search state, row - source row, from - candidate so
+//             far, pos - result column to go on from, loose - source
+//             columns left free as blanks in this row
+//==============================================================================
+static void searchRow(CanonSearch &search, const unsigned char *row, const CanonCandidate &from,
+                      int pos, int loose) {
+    const unsigned char *first = search.grid[from.transposed] + from.rowOrder[0] * 9;
+    CanonCandidate state = from;
+
+    for (; pos < 9; pos++) {
+        int col = state.colOrder[pos];
+        if (col != 9) {
+            if (!keepCell(search, pos, cellValue(search, state, row, col))) {
+                return;
+            }
+            continue;
+        }
+
+        // a free result stack takes any source stack that fits; a column
+        // placed on a clue picks its stack itself
+        int slot = pos / 3;
+        if (state.slotStack[slot] == 3 && search.rank[pos] == 0) {
+            for (int stack = 0; stack < 3; stack++) {
+                CanonCandidate next = state;
+                if (fitStack(search, next, stack, slot)) {
+                    searchRow(search, row, next, pos, loose);
+                }
+            }
+            return;
+        }
+
+        // free columns always start their stack, so this is where the
+        // blanks of this row go
+        if (search.rank[pos] == 0 && pos % 3 == 0) {
+            int stack = state.slotStack[slot];
+            int blanks = 0;
+            for (int c = stack * 3; c < stack * 3 + 3; c++) {
+                if (state.posOf[c] == 9 && first[c] == 0 && row[c] == 0) {
+                    loose |= 1 << c;
+                    blanks++;
+                }
+            }
+            if (blanks > 1) {
+                for (int i = 0; i < blanks; i++) {
+                    if (!keepCell(search, pos + i, 0)) {
+                        return;
+                    }
+                }
+                pos += blanks - 1;
+                continue;
+            }
+            loose &= ~(7 << (stack * 3));
+        }
+
+        for (int c = 0; c < 9; c++) {
+            if (state.posOf[c] != 9 || (loose & (1 << c)) || (first[c] == 0) != (search.rank[pos] == 0)) {
+                continue;
+            }
+            if (state.slotStack[slot] != 3 && state.slotStack[slot] != c / 3) {
+                continue;
+            }
+            CanonCandidate next = state;
+            if (placeColumn(search, next, c, pos) && keepCell(search, pos, cellValue(search, next, row, c))) {
+                searchRow(search, row, next, pos + 1, loose);
+            }
+        }
+        return;
+    }
+
+    search.found->push_back(state);
+}                         // end of searchRow
+//==============================================================================
+
+//====canonicalForm=============================================================
+// Description: Finds the minlex form of a board: the smallest 81-cell string
+//              (blanks as 0) over transposition, band/stack order, row and
+//              column order within them, and digit relabeling. Builds the
+//              result one row at a time and keeps only the transforms that
+//              tie for the smallest row so far, so it never walks the whole
+//              symmetry group. The board must not repeat a digit in a row
+//              or column
+// Parameters: board - board to canonicalize, canon - receives the minlex
+//             form, with every filled cell marked as a given
+//==============================================================================
+void canonicalForm(const PackedBoard &board, PackedBoard &canon) {
+    CanonSearch search;
+    for (int x = 0; x < 9; x++) {
+        for (int y = 0; y < 9; y++) {
+            search.grid[0][x * 9 + y] = board.get(x, y);
+            search.grid[1][y * 9 + x] = board.get(x, y);
+        }
+    }
+
+    // reused between calls; the tie lists are rebuilt for every row
+    static thread_local vector<CanonCandidate> current;
+    static thread_local vector<CanonCandidate> next;
+    current.clear();
+
+    // blanks sort first, so only rows whose best blank layout is the
+    // smallest one can start the minlex form: stacks with the fewest clues
+    // go first, blanks first within each stack
+    int layout[2][9];
+    int bestLayout = 1 << 9;
+    for (int t = 0; t < 2; t++) {
+        for (int r = 0; r < 9; r++) {
+            search.digits[t][r] = 0;
+            for (int col = 0; col < 9; col++) {
+                search.digits[t][r] |= 1 << search.grid[t][r * 9 + col];
+            }
+
+            int clues[3];
+            for (int stack = 0; stack < 3; stack++) {
+                const unsigned char *cell = search.grid[t] + r * 9 + stack * 3;
+                clues[stack] = (cell[0] != 0) + (cell[1] != 0) + (cell[2] != 0);
+            }
+            sort(clues, clues + 3);
+
+            layout[t][r] = 0;
+            for (int stack = 0; stack < 3; stack++) {
+                layout[t][r] = (layout[t][r] << 3) | ((1 << clues[stack]) - 1);
+            }
+            bestLayout = min(bestLayout, layout[t][r]);
+        }
+    }
+
+    // the layout alone fixes the first row, whatever the column order: its
+    // clues are relabeled 1, 2, ... from the left. So no columns are placed
+    // for it; the second row places them as it needs
+    int clues = 0;
+    for (int pos = 0; pos < 9; pos++) {
+        search.rank[pos] = (bestLayout >> (8 - pos)) & 1 ? ++clues : 0;
+        canon.cells[pos] = search.rank[pos];
+    }
+    for (int slot = 0; slot < 3; slot++) {
+        search.slotClues[slot] = (search.rank[slot * 3] != 0) + (search.rank[slot * 3 + 1] != 0) +
+                                 (search.rank[slot * 3 + 2] != 0);
+    }
+
+    search.bestLen = 0;
+    search.found = &current;
+    for (int t = 0; t < 2; t++) {
+        for (int r = 0; r < 9; r++) {
+            if (layout[t][r] != bestLayout) {
+                continue;
+            }
+
+            CanonCandidate cand;
+            memset(&cand, 0, sizeof(cand));
+            memset(cand.colOrder, 9, sizeof(cand.colOrder));
+            memset(cand.posOf, 9, sizeof(cand.posOf));
+            memset(cand.slotStack, 3, sizeof(cand.slotStack));
+            memset(cand.stackSlot, 3, sizeof(cand.stackSlot));
+            cand.transposed = t;
+            cand.rowOrder[0] = r;
+            cand.nextLabel = clues + 1;
+
+            // the second row finishes the first one's band
+            for (int second = r - r % 3; second < r - r % 3 + 3; second++) {
+                if (second != r) {
+                    cand.rowOrder[1] = second;
+                    searchRow(search, search.grid[t] + second * 9, cand, 0, 0);
+                }
+            }
+        }
+    }
+    memcpy(canon.cells + 9, search.best, 9);
+
+    // remaining rows: rows finishing the current band, or any row of an
+    // unused band
+    for (int depth = 2; depth < 9; depth++) {
+        search.bestLen = 0;
+        search.found = &next;
+        next.clear();
+
+        for (const CanonCandidate &cand : current) {
+            const unsigned char *source = search.grid[cand.transposed];
+
+            int options[9];
+            int count = 0;
+            int bandStart = depth - depth % 3;
+            if (depth % 3) {
+                int band = cand.rowOrder[bandStart] / 3;
+                for (int r = band * 3; r < band * 3 + 3; r++) {
+                    bool used = false;
+                    for (int i = bandStart; i < depth; i++) {
+                        used |= cand.rowOrder[i] == r;
+                    }
+                    if (!used) {
+                        options[count++] = r;
+                    }
+                }
+            } else {
+                for (int band = 0; band < 3; band++) {
+                    bool used = false;
+                    for (int i = 0; i < depth; i += 3) {
+                        used |= cand.rowOrder[i] / 3 == band;
+                    }
+                    for (int r = band * 3; !used && r < band * 3 + 3; r++) {
+                        options[count++] = r;
+                    }
+                }
+            }
+
+            for (int k = 0; k < count; k++) {
+                CanonCandidate option = cand;
+                option.rowOrder[depth] = options[k];
+                searchRow(search, source + options[k] * 9, option, 0, 0);
+            }
+        }
+
+        memcpy(canon.cells + depth * 9, search.best, 9);
+        current.swap(next);
+    }
+
+    canon.markGivens();
+}                         // end of canonicalForm
+//==============================================================================
+
+//====canonicalHash=============================================================
+// Description: Hashes a canonical board (64-bit FNV-1a over its cells)
+// Parameters: canon - board from canonicalForm
+// Return: hash shared by every board of the same symmetry class
+//==============================================================================
+uint64_t canonicalHash(const PackedBoard &canon) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (int i = 0; i < 81; i++) {
+        hash = (hash ^ canon.cells[i]) * 1099511628211ULL;
+    }
+    return hash;
+}                         // end of canonicalHash
+//==============================================================================
+
+//====lineSignature=============================================================
+// Description: Describes how the clues spread over the lines of one
+//              direction, ignoring the order of bands and of lines within them
+// Parameters: counts - clues in each line
+// Return: sorted per-band line counts packed into one number
+//==============================================================================
+static uint64_t lineSignature(const int counts[9]) {
+    int bands[3];
+    for (int b = 0; b < 3; b++) {
+        int line[3] = {counts[b * 3], counts[b * 3 + 1], counts[b * 3 + 2]};
+        sort(line, line + 3);
+        bands[b] = (line[0] * 10 + line[1]) * 10 + line[2];
+    }
+    sort(bands, bands + 3);
+    return ((uint64_t) bands[0] * 1000 + bands[1]) * 1000 + bands[2];
+}                         // end of lineSignature
+//==============================================================================
+
+//====symmetryFingerprint=======================================================
+// Description: Hashes properties that no symmetry changes: line and box clue
+//              counts, each clue's (row + column, box) counts and the digit
+//              frequencies. Equivalent boards always match; different ones
+//              usually don't
+// Parameters: board - board to fingerprint
+// Return: fingerprint
+//==============================================================================
+uint64_t symmetryFingerprint(const PackedBoard &board) {
+    int rowCount[9] = {0};
+    int colCount[9] = {0};
+    int boxCount[9] = {0};
+    int digitCount[10] = {0};
+
+    for (int x = 0; x < 9; x++) {
+        for (int y = 0; y < 9; y++) {
+            int num = board.get(x, y);
+            if (num) {
+                rowCount[x]++;
+                colCount[y]++;
+                boxCount[(x / 3) * 3 + y / 3]++;
+            }
+            digitCount[num]++;
+        }
+    }
+
+    // clue profile: how many clues share each (row + column, box) count
+    unsigned char profile[19 * 10] = {0};
+    for (int x = 0; x < 9; x++) {
+        for (int y = 0; y < 9; y++) {
+            if (board.get(x, y)) {
+                profile[(rowCount[x] + colCount[y]) * 10 + boxCount[(x / 3) * 3 + y / 3]]++;
+            }
+        }
+    }
+
+    uint64_t rows = lineSignature(rowCount);
+    uint64_t cols = lineSignature(colCount);
+    sort(digitCount + 1, digitCount + 10);
+
+    uint64_t hash = 14695981039346656037ULL;
+    uint64_t parts[3] = {min(rows, cols), max(rows, cols), (uint64_t) digitCount[0]};
+    for (uint64_t part : parts) {
+        hash = (hash ^ part) * 1099511628211ULL;
+    }
+    for (int d = 1; d < 10; d++) {
+        hash = (hash ^ digitCount[d]) * 1099511628211ULL;
+    }
+    for (unsigned char count : profile) {
+        hash = (hash ^ count) * 1099511628211ULL;
+    }
+    return hash;
+}                         // end of symmetryFingerprint
+//==============================================================================
+
+// Constructor
+DedupIndex::DedupIndex() {
+    this->entries = 0;
+    this->canonicalized = 0;
+}
+
+//====insert====================================================================
+// Description: Adds a board unless an equivalent one is already indexed
+// Parameters: board - board to add
+// Return: true if it was new, false if it duplicates an earlier board
+//==============================================================================
+bool DedupIndex::insert(const PackedBoard &board) {
+    vector<Entry> &bucket = buckets[symmetryFingerprint(board)];
+
+    Entry entry;
+    entry.board = board;
+    entry.hasCanon = false;
+
+    // only a shared fingerprint needs the exact comparison
+    if (!bucket.empty()) {
+        canonicalForm(board, entry.canon);
+        entry.hasCanon = true;
+        canonicalized++;
+
+        for (Entry &other : bucket) {
+            if (!other.hasCanon) {
+                canonicalForm(other.board, other.canon);
+                other.hasCanon = true;
+                canonicalized++;
+            }
+            if (!memcmp(other.canon.cells, entry.canon.cells, 81)) {
+                return false;
+            }
+        }
+    }
+
+    bucket.push_back(entry);
+    entries++;
+    return true;
+}                         // end of insert
+//==============================================================================
+
+//====size======================================================================
+// Description: Returns the number of distinct boards indexed
+// Return: number of symmetry classes seen
+//==============================================================================
+long long DedupIndex::size() {
+    return entries;
+}                         // end of size
+//==============================================================================
+
+//====getCanonicalCount=========================================================
+// Description: Returns how many minlex forms the index had to work out
+// Return: number of canonicalForm calls
+//==============================================================================
+long long DedupIndex::getCanonicalCount() {
+    return canonicalized;
+}                         // end of getCanonicalCount
+//==============================================================================
+
+#endif // CANONICAL_H
@@ -0,0 +1,58 @@
+// Canonical.h - header file
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+using namespace std;
+
+// One partly built transform while searching for the minlex form. Columns
+// are only placed once a result row needs them: until then a column is free
+// (colOrder 9), which keeps orders no row so far tells apart in one candidate
+struct CanonCandidate {
+    unsigned char transposed;       // 1 if reading the transposed grid
+    unsigned char rowOrder[9];      // source row of each result row so far
+    unsigned char colOrder[9];      // source column of each result column, 9 if free
+    unsigned char posOf[9];         // source column -> result column, 9 if free
+    unsigned char slotStack[3];     // source stack of each result stack, 3 if free
+    unsigned char stackSlot[3];     // result stack of each source stack, 3 if free
+    unsigned char label[10];        // source digit -> result digit, 0 if unset
+    unsigned char nextLabel;        // next result digit to hand out
+};
+
+// State shared by the candidates while one result row is searched
+struct CanonSearch {
+    unsigned char grid[2][81];      // the board and its transpose
+    unsigned short digits[2][9];    // bit d set if digit d is in that row
+    unsigned char rank[9];          // result row 0: blanks, then clues 1, 2, ...
+    unsigned char slotClues[3];     // clues of each result stack in row 0
+    unsigned char best[9];          // smallest row so far
+    int bestLen;                    // cells of best that are set
+    vector<CanonCandidate> *found;  // candidates tied for best
+};
+
+void canonicalForm(const PackedBoard &board, PackedBoard &canon);
+uint64_t canonicalHash(const PackedBoard &canon);
+uint64_t symmetryFingerprint(const PackedBoard &board);
+
+// Streams puzzles and remembers one of each symmetry class. Puzzles are
+// bucketed by a cheap invariant fingerprint; the minlex form is only worked
+// out when a bucket already holds something
+class DedupIndex {
+private:
+    struct Entry {
+        PackedBoard board;
+        PackedBoard canon;
+        bool hasCanon;              // canon filled in yet
+    };
+
+    unordered_map<uint64_t, vector<Entry>> buckets;
+    long long entries;
+    long long canonicalized;        // minlex forms computed
+
+public:
+    DedupIndex();
+    bool insert(const PackedBoard &board);
+    long long size();
+    long long getCanonicalCount();
+};
@@ -0,0 +1,302 @@
+// DancingLinks.cpp - implementation file
+#ifndef DANCINGLINKS_H
+#define DANCINGLINKS_H
+
+#include "PackedBoard.h"
+#include "DancingLinks.h"
+#include <algorithm>
+using namespace std;
+
+// Constructor
+DancingLinks::DancingLinks() {
+    this->cancel = nullptr;
+    build();
+}
+
+//====build=====================================================================
+// Description: Links the full exact-cover matrix. Row r places digit
+//              (r % 9) + 1 in cell r / 9 and covers four columns: the cell,
+//              and the digit in its row, column and box
+//==============================================================================
+void DancingLinks::build() {
+    // column headers in a circular list around the root
+    for (int c = 0; c <= COLUMNS; c++) {
+        left[c] = c - 1;
+        right[c] = c + 1;
+        up[c] = c;
+        down[c] = c;
+        size[c] = 0;
+    }
+    left[0] = COLUMNS;
+    right[COLUMNS] = 0;
+
+    int node = COLUMNS + 1;
+    for (int r = 0; r < ROWS; r++) {
+        int cell = r / 9;
+        int digit = r % 9;
+        int x = cell / 9;
+        int y = cell % 9;
+        int box = (x / 3) * 3 + y / 3;
+        int cols[4] = {
+            1 + cell,
+            1 + 81 + x * 9 + digit,
+            1 + 162 + y * 9 + digit,
+            1 + 243 + box * 9 + digit
+        };
+
+        rowStart[r] = node;
+        for (int k = 0; k < 4; k++) {
+            int n = node + k;
+            int c = cols[k];
+
+            // append to the bottom of the column
+            column[n] = c;
+            rowOf[n] = r;
+            up[n] = up[c];
+            down[n] = c;
+            down[up[c]] = n;
+            up[c] = n;
+            size[c]++;
+
+            // circular list across the row
+            left[n] = node + (k + 3) % 4;
+            right[n] = node + (k + 1) % 4;
+        }
+        node += 4;
+    }
+
+    depth = 0;
+    conflict = false;
+    recordSolution = false;
+    nodes = 0;
+    backtracks = 0;
+    maxDepth = 0;
+}                         // end of build
+//==============================================================================
+
+//====cover=====================================================================
+// Description: Removes a column and every row that uses it
+// Parameters: c - column header
+//==============================================================================
+void DancingLinks::cover(int c) {
+    right[left[c]] = right[c];
+    left[right[c]] = left[c];
+
+    for (int i = down[c]; i != c; i = down[i]) {
+        for (int j = right[i]; j != i; j = right[j]) {
+            down[up[j]] = down[j];
+            up[down[j]] = up[j];
+            size[column[j]]--;
+        }
+    }
+}                         // end of cover
+//==============================================================================
+
+//====uncover===================================================================
+// Description: Restores a column removed by cover, in reverse order
+// Parameters: c - column header
+//==============================================================================
+void DancingLinks::uncover(int c) {
+    for (int i = up[c]; i != c; i = up[i]) {
+        for (int j = left[i]; j != i; j = left[j]) {
+            size[column[j]]++;
+            down[up[j]] = j;
+            up[down[j]] = j;
+        }
+    }
+
+    right[left[c]] = c;
+    left[right[c]] = c;
+}                         // end of uncover
+//==============================================================================
+
+//====load======================================================================
+// Description: Resets the matrix and selects the rows of the given numbers
+// Parameters: board - packed 9x9 grid, 0 for empty cells
+// Return: true if the givens are consistent, false otherwise
+//==============================================================================
+bool DancingLinks::load(const PackedBoard &board) {
+    build();
+
+    for (int x = 0; x < 9; x++) {
+        for (int y = 0; y < 9; y++) {
+            if (board.get(x, y) == 0) {
+                continue;
+            }
+
+            // a column already covered means two givens clash
+            int first = rowStart[(x * 9 + y) * 9 + board.get(x, y) - 1];
+            int n = first;
+            do {
+                int c = column[n];
+                if (right[left[c]] != c) {
+                    conflict = true;
+                    return false;
+                }
+                n = right[n];
+            } while (n != first);
+
+            n = first;
+            do {
+                cover(column[n]);
+                n = right[n];
+            } while (n != first);
+        }
+    }
+
+    return true;
+}                         // end of load
+//==============================================================================
+
+//====search====================================================================
+// Description: Algorithm X, branching on the column with the fewest rows
+// Parameters: limit - stop once this many are found (0 counts them all)
+// Return: number of solutions
+//==============================================================================
+int DancingLinks::search(int limit) {
+    // another thread already has the answer
+    if (cancel && cancel->load(memory_order_relaxed)) {
+        return 0;
+    }
+
+    // every constraint satisfied
+    if (right[0] == 0) {
+        if (recordSolution) {
+            for (int i = 0; i < depth; i++) {
+                int cell = chosen[i] / 9;
+                solution[cell / 9][cell % 9] = chosen[i] % 9 + 1;
+            }
+            recordSolution = false;
+        }
+        return 1;
+    }
+
+    // pick the column with the fewest rows left
+    int c = right[0];
+    for (int j = right[c]; j != 0; j = right[j]) {
+        if (size[j] < size[c]) {
+            c = j;
+        }
+    }
+    if (size[c] == 0) {
+        return 0;
+    }
+
+    int solutions = 0;
+    cover(c);
+    for (int r = down[c]; r != c; r = down[r]) {
+        nodes++;
+        chosen[depth++] = rowOf[r];
+        maxDepth = max(maxDepth, depth);
+        for (int j = right[r]; j != r; j = right[j]) {
+            cover(column[j]);
+        }
+
+        int found = search(limit ? limit - solutions : 0);
+        if (found == 0) {
+            backtracks++;
+        }
+        solutions += found;
+
+        for (int j = left[r]; j != r; j = left[j]) {
+            uncover(column[j]);
+        }
+        depth--;
+
+        if (limit && solutions >= limit) {
+            break;
+        }
+    }
+    uncover(c);
+
+    return solutions;
+}                         // end of search
+//==============================================================================
+
+//====count=====================================================================
+// Description: Counts the solutions of the loaded board
+// Parameters: limit - stop once this many are found (0 counts them all)
+// Return: number of solutions
+//==============================================================================
+int DancingLinks::count(int limit) {
+    if (conflict) {
+        return 0;
+    }
+
+    nodes = 0;
+    backtracks = 0;
+    maxDepth = 0;
+    return search(limit);
+}                         // end of count
+//==============================================================================
+
+//====solve=====================================================================
+// Description: Fills in a board with its first solution
+// Parameters: board - packed 9x9 grid, 0 for empty cells; left as is if
+//             unsolvable
+// Return: true if a solution was found, false otherwise
+//==============================================================================
+bool DancingLinks::solve(PackedBoard &board) {
+    if (!load(board)) {
+        return false;
+    }
+
+    for (int x = 0; x < 9; x++) {
+        for (int y = 0; y < 9; y++) {
+            solution[x][y] = board.get(x, y);
+        }
+    }
+
+    recordSolution = true;
+    if (count(1) == 0) {
+        recordSolution = false;
+        return false;
+    }
+
+    for (int x = 0; x < 9; x++) {
+        for (int y = 0; y < 9; y++) {
+            board.set(x, y, solution[x][y]);
+        }
+    }
+
+    return true;
+}                         // end of solve
+//==============================================================================
+
+//====getNodeCount==============================================================
+// Description: Returns the search tree size of the last count or solve
+// Return: number of rows tried
+//==============================================================================
+long long DancingLinks::getNodeCount() {
+    return nodes;
+}                         // end of getNodeCount
+//==============================================================================
+
+//====getBacktrackCount=========================================================
+// Description: Returns the dead ends of the last count or solve
+// Return: number of rows tried whose subtree had no solution
+//==============================================================================
+long long DancingLinks::getBacktrackCount() {
+    return backtracks;
+}                         // end of getBacktrackCount
+//==============================================================================
+
+//====getMaxDepth===============================================================
+// Description: Returns how deep the last count or solve went
+// Return: most rows chosen at once
+//==============================================================================
+int DancingLinks::getMaxDepth() {
+    return maxDepth;
+}                         // end of getMaxDepth
+//==============================================================================
+
+//====setCancelFlag=============================================================
+// Description: Sets a flag that makes a running search give up once set
+// Parameters: flag - cancel flag, or nullptr to never stop early
+//==============================================================================
+void DancingLinks::setCancelFlag(const atomic<bool> *flag) {
+    this->cancel = flag;
+}                         // end of setCancelFlag
+//==============================================================================
+
+#endif
@@ -0,0 +1,46 @@
+// DancingLinks.h - header file
+
+#include <atomic>
+using namespace std;
+
+class DancingLinks {
+private:
+    static const int COLUMNS = 324;             // 81 cells + 3 * 81 digit rules
+    static const int ROWS = 729;                // 81 cells * 9 digits
+    static const int NODES = 1 + COLUMNS + ROWS * 4;
+
+    // node pool: 0 is the root, 1-324 the column headers, the rest the rows
+    int left[NODES];
+    int right[NODES];
+    int up[NODES];
+    int down[NODES];
+    int column[NODES];
+    int rowOf[NODES];
+    int size[COLUMNS + 1];
+    int rowStart[ROWS];
+
+    int chosen[81];                             // rows picked by the search
+    int depth;
+    bool conflict;                              // givens break a rule
+    bool recordSolution;
+    int solution[9][9];
+    long long nodes;
+    long long backtracks;                       // rows whose subtree had no solution
+    int maxDepth;                               // most rows chosen at once
+    const atomic<bool> *cancel;                 // stop searching once set
+
+    void build();
+    void cover(int c);
+    void uncover(int c);
+    int search(int limit);
+
+public:
+    DancingLinks();
+    bool load(const PackedBoard &board);
+    int count(int limit);
+    bool solve(PackedBoard &board);
+    long long getNodeCount();
+    long long getBacktrackCount();
+    int getMaxDepth();
+    void setCancelFlag(const atomic<bool> *flag);
+};
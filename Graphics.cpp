@@ -11,7 +11,8 @@ using namespace std;
 void createTitle(SDL_Renderer *renderer);
 void createPlayButton(SDL_Renderer *renderer);
 void createDifficultyButton(SDL_Renderer *renderer, int difficulty);
-void renderNum(SDL_Renderer *renderer, Sudoku game);
+void renderNum(SDL_Renderer *renderer, const Sudoku &game);
+void renderNotes(SDL_Renderer *renderer, const Sudoku &game, int pencil);
 void createGrid(SDL_Renderer *renderer);
 string formatTime(int time);
 void createSubmitButton(SDL_Renderer *renderer);
@@ -41,9 +42,10 @@ void printStartScreen(SDL_Renderer *renderer) {
 
 //====printGameScreen===========================================================
 //Description: Prints the game screen
-//Parameter: renderer - SDL renderer, game - Sudoku object
+//Parameter: renderer - SDL renderer, game - Sudoku object, pencil - which
+//           pencil marks to show, see PencilMarks
 //==============================================================================
-void printGameScreen(SDL_Renderer *renderer, Sudoku game) {
+void printGameScreen(SDL_Renderer *renderer, const Sudoku &game, int pencil = PENCIL_OFF) {
     // Set background color (white)
     SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
     SDL_RenderClear(renderer);
@@ -54,6 +56,9 @@ void printGameScreen(SDL_Renderer *renderer, Sudoku game) {
     // Draw numbers
     renderNum(renderer, game);
 
+    // Draw pencil marks
+    renderNotes(renderer, game, pencil);
+
     // Draw submit button
     createSubmitButton(renderer);
 
@@ -300,7 +305,7 @@ void createGrid(SDL_Renderer *renderer) {
 // Description: Renders the numbers to the screen
 // Parameters: renderer - SDL renderer, game - Sudoku object
 //==============================================================================
-void renderNum(SDL_Renderer *renderer, Sudoku game) {
+void renderNum(SDL_Renderer *renderer, const Sudoku &game) {
     TTF_Font *font = TTF_OpenFont("src/font/ByteBounce.ttf", 40);
 
     int offset = (800 - BOARD_SIZE) / 2;
@@ -315,8 +320,10 @@ void renderNum(SDL_Renderer *renderer, Sudoku game) {
                 continue;
             }
             
-            // select color
-            if (game.isNewNum(row, col)) {
+            // select color: red for a number repeated in its row, column or box
+            if (game.isConflict(row, col)) {
+                color = colors.red;
+            } else if (game.isNewNum(row, col)) {
                 color = colors.vibrantBlue;
             } else {
                 color = colors.black;
@@ -347,6 +354,165 @@ void renderNum(SDL_Renderer *renderer, Sudoku game) {
 }                        // end of renderNum
 //==============================================================================
 
+// Pencil-mark digits, rendered once into a single texture so a frame full
+// of marks is one SDL_RenderCopy per mark and no text rendering. A renderer
+// that can't draw into a texture keeps one texture per digit instead
+struct GlyphAtlas {
+    SDL_Texture *texture = nullptr;
+    SDL_Texture *digits[10] = {nullptr};    // per-digit fallback
+    SDL_Rect glyphs[10];        // where each digit sits in the texture
+    bool built = false;         // build tried, even if it failed
+    bool ready = false;         // glyphs can be drawn
+};
+
+GlyphAtlas miniDigits;
+
+//====freeMiniDigits============================================================
+// Description: Frees the glyph textures; call before destroying the renderer
+//==============================================================================
+void freeMiniDigits() {
+    if (miniDigits.texture != nullptr) {
+        SDL_DestroyTexture(miniDigits.texture);
+        miniDigits.texture = nullptr;
+    }
+    for (int num = 1; num <= 9; num++) {
+        if (miniDigits.digits[num] != nullptr) {
+            SDL_DestroyTexture(miniDigits.digits[num]);
+            miniDigits.digits[num] = nullptr;
+        }
+    }
+    miniDigits.ready = false;
+}                        // end of freeMiniDigits
+//==============================================================================
+
+//====loadMiniDigits============================================================
+// Description: Renders the digits 1-9 side by side into the atlas texture.
+//              Runs once: a missing font isn't reopened every frame
+// Parameters: renderer - SDL renderer
+// Return: true if the glyphs are ready
+//==============================================================================
+bool loadMiniDigits(SDL_Renderer *renderer) {
+    miniDigits.built = true;
+    TTF_Font *font = TTF_OpenFont("src/font/ByteBounce.ttf", CELL_SIZE / 3);
+    if (font == nullptr) {
+        return false;
+    }
+
+    Color colors;
+    int width = 0;
+    int height = 0;
+
+    // Render each digit once and lay them out in a row
+    for (int num = 1; num <= 9; num++) {
+        string numStr = to_string(num);
+        SDL_Surface *surface = TTF_RenderText_Solid(font, numStr.c_str(), colors.darkGray);
+        if (surface == nullptr) {
+            TTF_CloseFont(font);
+            freeMiniDigits();
+            return false;
+        }
+        miniDigits.digits[num] = SDL_CreateTextureFromSurface(renderer, surface);
+
+        miniDigits.glyphs[num] = {width, 0, surface->w, surface->h};
+        width += surface->w;
+        height = max(height, surface->h);
+        SDL_FreeSurface(surface);
+
+        if (miniDigits.digits[num] == nullptr) {
+            TTF_CloseFont(font);
+            freeMiniDigits();
+            return false;
+        }
+    }
+    TTF_CloseFont(font);
+    miniDigits.ready = true;
+
+    // Copy them into one transparent texture, if the renderer can draw
+    // into one; otherwise keep drawing from the digit textures
+    if (!SDL_RenderTargetSupported(renderer)) {
+        return true;
+    }
+    SDL_Texture *atlas = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888,
+                                           SDL_TEXTUREACCESS_TARGET, width, height);
+    if (atlas == nullptr) {
+        return true;
+    }
+    if (SDL_SetRenderTarget(renderer, atlas) != 0) {
+        SDL_DestroyTexture(atlas);
+        return true;
+    }
+    SDL_SetTextureBlendMode(atlas, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    SDL_RenderClear(renderer);
+
+    for (int num = 1; num <= 9; num++) {
+        SDL_RenderCopy(renderer, miniDigits.digits[num], nullptr, &miniDigits.glyphs[num]);
+        SDL_DestroyTexture(miniDigits.digits[num]);
+        miniDigits.digits[num] = nullptr;
+    }
+    SDL_SetRenderTarget(renderer, nullptr);
+    miniDigits.texture = atlas;
+
+    return true;
+}                        // end of loadMiniDigits
+//==============================================================================
+
+//====renderNotes===============================================================
+// Description: Draws the pencil marks of the empty cells, each number in its
+//              own spot of a 3x3 layout inside the cell
+// Parameters: renderer - SDL renderer, game - Sudoku object, pencil - which
+//             marks to show, see PencilMarks
+//==============================================================================
+void renderNotes(SDL_Renderer *renderer, const Sudoku &game, int pencil) {
+    if (pencil == PENCIL_OFF) {
+        return;
+    }
+    if (!miniDigits.built) {
+        loadMiniDigits(renderer);
+    }
+    if (!miniDigits.ready) {
+        return;
+    }
+
+    int offset = (800 - BOARD_SIZE) / 2;
+    int spot = CELL_SIZE / 3;
+
+    for (int row = 0; row < 9; row++) {
+        for (int col = 0; col < 9; col++) {
+            if (game.getBoard(row, col) != 0) {
+                continue;
+            }
+
+            unsigned short marks;
+            if (pencil == PENCIL_AUTO) {
+                marks = game.getCandidates(row, col);
+            } else {
+                marks = game.getNotes(row, col);
+            }
+
+            // One copy out of the atlas per mark
+            while (marks != 0) {
+                int num = __builtin_ctz(marks) + 1;
+                marks &= marks - 1;
+
+                const SDL_Rect &glyph = miniDigits.glyphs[num];
+                SDL_Rect markRect = {
+                    offset + col * CELL_SIZE + ((num - 1) % 3) * spot + (spot - glyph.w) / 2,
+                    offset + row * CELL_SIZE + ((num - 1) / 3) * spot + (spot - glyph.h) / 2,
+                    glyph.w,
+                    glyph.h
+                };
+                if (miniDigits.texture != nullptr) {
+                    SDL_RenderCopy(renderer, miniDigits.texture, &glyph, &markRect);
+                } else {
+                    SDL_RenderCopy(renderer, miniDigits.digits[num], nullptr, &markRect);
+                }
+            }
+        }
+    }
+}                        // end of renderNotes
+//==============================================================================
+
 //====createTimer===============================================================
 // Description: Creates the timer
 // Parameters: renderer - SDL renderer, elapsedTime - time elapsed
@@ -0,0 +1,57 @@
+// Lanes.h - SIMD helpers shared by the batch kernels
+#ifndef LANES_H
+#define LANES_H
+
+#if defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
+const int LANE_WIDTH = 16;      // boards handled per vector operation
+
+// A row of LANE_WIDTH 16-bit masks: one AVX2 register, two SSE registers, or a
+// plain array the compiler may vectorize on its own
+#if defined(__AVX2__)
+typedef __m256i LaneVector;
+
+static inline LaneVector laneLoad(const unsigned short *p) { return _mm256_load_si256((const __m256i *) p); }
+static inline void laneStore(unsigned short *p, LaneVector a) { _mm256_store_si256((__m256i *) p, a); }
+static inline LaneVector laneZero() { return _mm256_setzero_si256(); }
+static inline LaneVector laneOr(LaneVector a, LaneVector b) { return _mm256_or_si256(a, b); }
+static inline LaneVector laneAnd(LaneVector a, LaneVector b) { return _mm256_and_si256(a, b); }
+static inline LaneVector laneAndNot(LaneVector a, LaneVector b) { return _mm256_andnot_si256(a, b); }
+static inline LaneVector laneXor(LaneVector a, LaneVector b) { return _mm256_xor_si256(a, b); }
+static inline LaneVector laneIsZero(LaneVector a) { return _mm256_cmpeq_epi16(a, _mm256_setzero_si256()); }
+static inline LaneVector laneMinusOne(LaneVector a) { return _mm256_sub_epi16(a, _mm256_set1_epi16(1)); }
+static inline LaneVector laneSplat(unsigned short v) { return _mm256_set1_epi16((short) v); }
+static inline bool laneAny(LaneVector a) { return !_mm256_testz_si256(a, a); }
+#elif defined(__SSE4_1__)
+struct LaneVector { __m128i lo, hi; };
+
+static inline LaneVector laneLoad(const unsigned short *p) { return {_mm_load_si128((const __m128i *) p), _mm_load_si128((const __m128i *) (p + 8))}; }
+static inline void laneStore(unsigned short *p, LaneVector a) { _mm_store_si128((__m128i *) p, a.lo); _mm_store_si128((__m128i *) (p + 8), a.hi); }
+static inline LaneVector laneZero() { return {_mm_setzero_si128(), _mm_setzero_si128()}; }
+static inline LaneVector laneOr(LaneVector a, LaneVector b) { return {_mm_or_si128(a.lo, b.lo), _mm_or_si128(a.hi, b.hi)}; }
+static inline LaneVector laneAnd(LaneVector a, LaneVector b) { return {_mm_and_si128(a.lo, b.lo), _mm_and_si128(a.hi, b.hi)}; }
+static inline LaneVector laneAndNot(LaneVector a, LaneVector b) { return {_mm_andnot_si128(a.lo, b.lo), _mm_andnot_si128(a.hi, b.hi)}; }
+static inline LaneVector laneXor(LaneVector a, LaneVector b) { return {_mm_xor_si128(a.lo, b.lo), _mm_xor_si128(a.hi, b.hi)}; }
+static inline LaneVector laneIsZero(LaneVector a) { return {_mm_cmpeq_epi16(a.lo, _mm_setzero_si128()), _mm_cmpeq_epi16(a.hi, _mm_setzero_si128())}; }
+static inline LaneVector laneMinusOne(LaneVector a) { return {_mm_sub_epi16(a.lo, _mm_set1_epi16(1)), _mm_sub_epi16(a.hi, _mm_set1_epi16(1))}; }
+static inline LaneVector laneSplat(unsigned short v) { return {_mm_set1_epi16((short) v), _mm_set1_epi16((short) v)}; }
+static inline bool laneAny(LaneVector a) { __m128i both = _mm_or_si128(a.lo, a.hi); return !_mm_testz_si128(both, both); }
+#else
+struct LaneVector { unsigned short v[LANE_WIDTH]; };
+
+static inline LaneVector laneLoad(const unsigned short *p) { LaneVector r; for (int i = 0; i < LANE_WIDTH; i++) r.v[i] = p[i]; return r; }
+static inline void laneStore(unsigned short *p, LaneVector a) { for (int i = 0; i < LANE_WIDTH; i++) p[i] = a.v[i]; }
+static inline LaneVector laneZero() { LaneVector r; for (int i = 0; i < LANE_WIDTH; i++) r.v[i] = 0; return r; }
+static inline LaneVector laneOr(LaneVector a, LaneVector b) { for (int i = 0; i < LANE_WIDTH; i++) a.v[i] |= b.v[i]; return a; }
+static inline LaneVector laneAnd(LaneVector a, LaneVector b) { for (int i = 0; i < LANE_WIDTH; i++) a.v[i] &= b.v[i]; return a; }
+static inline LaneVector laneAndNot(LaneVector a, LaneVector b) { for (int i = 0; i < LANE_WIDTH; i++) a.v[i] = ~a.v[i] & b.v[i]; return a; }
+static inline LaneVector laneXor(LaneVector a, LaneVector b) { for (int i = 0; i < LANE_WIDTH; i++) a.v[i] ^= b.v[i]; return a; }
+static inline LaneVector laneIsZero(LaneVector a) { for (int i = 0; i < LANE_WIDTH; i++) a.v[i] = a.v[i] ? 0 : 0xFFFF; return a; }
+static inline LaneVector laneMinusOne(LaneVector a) { for (int i = 0; i < LANE_WIDTH; i++) a.v[i] -= 1; return a; }
+static inline LaneVector laneSplat(unsigned short v) { LaneVector r; for (int i = 0; i < LANE_WIDTH; i++) r.v[i] = v; return r; }
+static inline bool laneAny(LaneVector a) { unsigned short any = 0; for (int i = 0; i < LANE_WIDTH; i++) any |= a.v[i]; return any != 0; }
+#endif
+
+#endif // LANES_H
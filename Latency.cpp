@@ -0,0 +1,129 @@
+// Latency.cpp - implementation file
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include "Latency.h"
+using namespace std;
+
+// Constructor
+LatencyHistogram::LatencyHistogram() {
+    for (int i = 0; i < BUCKETS; i++) {
+        buckets[i] = 0;
+    }
+    this->count = 0;
+    this->total = 0;
+    this->maximum = 0;
+}
+
+//====bucketOf==================================================================
+// Description: Maps a latency to its bucket. Values below 8 ns get a bucket
+//              each, larger ones are split 8 ways per power of two, so a
+//              bucket is never more than 12.5% wide
+// Parameters: ns - latency in nanoseconds
+// Return: bucket index
+//==============================================================================
+int LatencyHistogram::bucketOf(long long ns) {
+    if (ns < 8) {
+        return ns < 0 ? 0 : (int) ns;
+    }
+
+    int top = 63 - __builtin_clzll(ns);
+    int sub = (int) (ns >> (top - 3)) & 7;
+    return (top - 2) * 8 + sub;
+}                         // end of bucketOf
+//==============================================================================
+
+//====bucketFloor===============================================================
+// Description: Returns the smallest latency that lands in a bucket
+// Parameters: index - bucket index
+// Return: latency in nanoseconds
+//==============================================================================
+long long LatencyHistogram::bucketFloor(int index) {
+    if (index < 8) {
+        return index;
+    }
+
+    int top = index / 8 + 2;
+    long long sub = index % 8;
+    return (8 + sub) << (top - 3);
+}                         // end of bucketFloor
+//==============================================================================
+
+//====add=======================================================================
+// Description: Records one latency
+// Parameters: ns - latency in nanoseconds
+//==============================================================================
+void LatencyHistogram::add(long long ns) {
+    buckets[bucketOf(ns)]++;
+    count++;
+    total += ns;
+    if (ns > maximum) {
+        maximum = ns;
+    }
+}                         // end of add
+//==============================================================================
+
+//====merge=====================================================================
+// Description: Adds another histogram's samples to this one
+// Parameters: other - histogram to fold in
+//==============================================================================
+void LatencyHistogram::merge(const LatencyHistogram &other) {
+    for (int i = 0; i < BUCKETS; i++) {
+        buckets[i] += other.buckets[i];
+    }
+    count += other.count;
+    total += other.total;
+    if (other.maximum > maximum) {
+        maximum = other.maximum;
+    }
+}                         // end of merge
+//==============================================================================
+
+//====getCount==================================================================
+// Description: Returns the number of samples
+//==============================================================================
+long long LatencyHistogram::getCount() {
+    return count;
+}                         // end of getCount
+//==============================================================================
+
+//====getMean===================================================================
+// Description: Returns the exact mean latency in nanoseconds
+//==============================================================================
+double LatencyHistogram::getMean() {
+    return count ? (double) total / count : 0.0;
+}                         // end of getMean
+//==============================================================================
+
+//====getMax====================================================================
+// Description: Returns the exact largest latency in nanoseconds
+//==============================================================================
+long long LatencyHistogram::getMax() {
+    return maximum;
+}                         // end of getMax
+//==============================================================================
+
+//====percentile================================================================
+// Description: Returns a latency percentile, rounded down to its bucket
+// Parameters: p - percentile, 0-100
+// Return: latency in nanoseconds, 0 if there are no samples
+//==============================================================================
+long long LatencyHistogram::percentile(double p) {
+    if (count == 0) {
+        return 0;
+    }
+
+    long long rank = (long long) (p / 100.0 * (count - 1));
+    long long seen = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+        seen += buckets[i];
+        if (seen > rank) {
+            return bucketFloor(i) < maximum ? bucketFloor(i) : maximum;
+        }
+    }
+
+    return maximum;
+}                         // end of percentile
+//==============================================================================
+
+#endif
@@ -0,0 +1,24 @@
+// Latency.h - header file
+
+using namespace std;
+
+class LatencyHistogram {
+private:
+    static const int BUCKETS = 8 * 62;      // 8 sub-buckets per power of two
+    long long buckets[BUCKETS];
+    long long count;
+    long long total;
+    long long maximum;
+
+    static int bucketOf(long long ns);
+    static long long bucketFloor(int index);
+
+public:
+    LatencyHistogram();
+    void add(long long ns);
+    void merge(const LatencyHistogram &other);
+    long long getCount();
+    double getMean();
+    long long getMax();
+    long long percentile(double p);
+};
@@ -0,0 +1,60 @@
+#ifndef PACKEDBOARD_H
+#define PACKEDBOARD_H
+
+#include <cstdint>
+#include <cstring>
+using namespace std;
+
+// Compact 9x9 board: one byte per cell plus a bitset of the given cells.
+// 104 bytes, so a snapshot or restore is a single fixed-size copy
+struct PackedBoard {
+    unsigned char cells[81];        // 0 for empty, 1-9 otherwise
+    uint64_t givens[2];             // bit i set if cell i is a given
+
+    // Empties every cell and forgets the givens
+    void clear() {
+        memset(cells, 0, sizeof(cells));
+        givens[0] = 0;
+        givens[1] = 0;
+    }
+
+    int get(int x, int y) const {
+        return cells[x * 9 + y];
+    }
+
+    void set(int x, int y, int num) {
+        cells[x * 9 + y] = (unsigned char) num;
+    }
+
+    bool isGiven(int x, int y) const {
+        int i = x * 9 + y;
+        return (givens[i >> 6] >> (i & 63)) & 1;
+    }
+
+    void setGiven(int x, int y) {
+        int i = x * 9 + y;
+        givens[i >> 6] |= (uint64_t) 1 << (i & 63);
+    }
+
+    // Marks every filled cell as a given and every empty one as open
+    void markGivens() {
+        givens[0] = 0;
+        givens[1] = 0;
+        for (int i = 0; i < 81; i++) {
+            if (cells[i] != 0) {
+                givens[i >> 6] |= (uint64_t) 1 << (i & 63);
+            }
+        }
+    }
+
+    // Empties every cell that isn't a given
+    void resetToGivens() {
+        for (int i = 0; i < 81; i++) {
+            if (!((givens[i >> 6] >> (i & 63)) & 1)) {
+                cells[i] = 0;
+            }
+        }
+    }
+};
+
+#endif // PACKEDBOARD_H
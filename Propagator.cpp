@@ -0,0 +1,491 @@
+// Propagator.cpp - implementation file
+#ifndef PROPAGATOR_H
+#define PROPAGATOR_H
+
+#include "PackedBoard.h"
+#include "Propagator.h"
+#include <algorithm>
+using namespace std;
+
+int Propagator::units[27][9];
+int Propagator::peers[81][20];
+once_flag Propagator::tablesBuilt;
+
+// Constructor
+Propagator::Propagator() {
+    buildTables();
+    this->recordSolution = false;
+    this->stats = {0, 0, 0, 0, 0, 0};
+    this->depth = 0;
+    this->cancel = nullptr;
+}
+
+//====buildTables===============================================================
+// Description: Fills the unit and peer tables shared by every Propagator.
+//              Safe to call from several threads; the work is done once
+//==============================================================================
+void Propagator::buildTables() {
+    call_once(tablesBuilt, [] {
+        for (int i = 0; i < 9; i++) {
+            for (int j = 0; j < 9; j++) {
+                units[i][j] = i * 9 + j;                                    // row i
+                units[9 + i][j] = j * 9 + i;                                // column i
+                units[18 + i][j] = ((i / 3) * 3 + j / 3) * 9 + (i % 3) * 3 + j % 3;  // box i
+            }
+        }
+
+        for (int cell = 0; cell < 81; cell++) {
+            int x = cell / 9;
+            int y = cell % 9;
+            int count = 0;
+
+            for (int other = 0; other < 81; other++) {
+                int ox = other / 9;
+                int oy = other % 9;
+                bool sameBox = ox / 3 == x / 3 && oy / 3 == y / 3;
+                if (other != cell && (ox == x || oy == y || sameBox)) {
+                    peers[cell][count++] = other;
+                }
+            }
+        }
+    });
+}                         // end of buildTables
+//==============================================================================
+
+//====load======================================================================
+// Description: Resets the candidates and places the given numbers
+// Parameters: board - packed 9x9 grid, 0 for empty cells
+// Return: true if the givens are consistent, false otherwise
+//==============================================================================
+bool Propagator::load(const PackedBoard &board) {
+    stats = {0, 0, 0, 0, 0, 0};
+    depth = 0;
+
+    for (int cell = 0; cell < 81; cell++) {
+        grid.cand[cell] = 0x1FF;
+        grid.value[cell] = 0;
+    }
+
+    for (int x = 0; x < 9; x++) {
+        for (int y = 0; y < 9; y++) {
+            if (board.get(x, y) != 0 && !assign(x * 9 + y, board.get(x, y))) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}                         // end of load
+//==============================================================================
+
+//====assign====================================================================
+// Description: Places a number and removes it from the cell's peers
+// Parameters: cell - index 0-80, num - number to place
+// Return: false if this leaves a peer with no candidates
+//==============================================================================
+bool Propagator::assign(int cell, int num) {
+    unsigned short bit = 1 << (num - 1);
+    if (!(grid.cand[cell] & bit)) {
+        return false;
+    }
+
+    grid.value[cell] = num;
+    grid.cand[cell] = bit;
+
+    for (int i = 0; i < 20; i++) {
+        int p = peers[cell][i];
+        if (grid.value[p] == 0 && (grid.cand[p] & bit)) {
+            grid.cand[p] &= ~bit;
+            if (grid.cand[p] == 0) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}                         // end of assign
+//==============================================================================
+
+//====eliminate=================================================================
+// Description: Removes candidates from an empty cell
+// Parameters: cell - index 0-80, bits - candidates to remove
+// Return: false if the cell is left with no candidates
+//==============================================================================
+bool Propagator::eliminate(int cell, unsigned short bits) {
+    unsigned short removed = grid.cand[cell] & bits;
+    if (grid.value[cell] != 0 || removed == 0) {
+        return true;
+    }
+
+    grid.cand[cell] &= ~bits;
+    stats.lockedCandidates += __builtin_popcount(removed);
+
+    return grid.cand[cell] != 0;
+}                         // end of eliminate
+//==============================================================================
+
+//====nakedSingles==============================================================
+// Description: Places every empty cell that has one candidate left
+// Parameters: changed - set to true if anything was placed
+// Return: false on a contradiction
+//==============================================================================
+bool Propagator::nakedSingles(bool &changed) {
+    for (int cell = 0; cell < 81; cell++) {
+        if (grid.value[cell] != 0) {
+            continue;
+        }
+
+        unsigned short open = grid.cand[cell];
+        if (open == 0) {
+            return false;
+        }
+
+        if ((open & (open - 1)) == 0) {
+            if (!assign(cell, __builtin_ctz(open) + 1)) {
+                return false;
+            }
+            stats.nakedSingles++;
+            changed = true;
+        }
+    }
+
+    return true;
+}                         // end of nakedSingles
+//==============================================================================
+
+//====hiddenSingles=============================================================
+// Description: Places every digit that fits in only one cell of a unit
+// Parameters: changed - set to true if anything was placed
+// Return: false on a contradiction
+//==============================================================================
+bool Propagator::hiddenSingles(bool &changed) {
+    for (int u = 0; u < 27; u++) {
+        unsigned short once = 0;
+        unsigned short twice = 0;
+        unsigned short placed = 0;
+
+        for (int i = 0; i < 9; i++) {
+            int cell = units[u][i];
+            if (grid.value[cell] != 0) {
+                placed |= grid.cand[cell];
+            } else {
+                twice |= once & grid.cand[cell];
+                once |= grid.cand[cell];
+            }
+        }
+
+        // a digit with nowhere to go
+        if ((once | placed) != 0x1FF) {
+            return false;
+        }
+
+        unsigned short single = once & ~twice & ~placed;
+        while (single) {
+            unsigned short bit = single & -single;
+            single &= single - 1;
+
+            int target = -1;
+            for (int i = 0; i < 9; i++) {
+                int cell = units[u][i];
+                if (grid.value[cell] == 0 && (grid.cand[cell] & bit)) {
+                    target = cell;
+                    break;
+                }
+            }
+
+            // an earlier single in this unit took the only cell
+            if (target < 0 || !assign(target, __builtin_ctz(bit) + 1)) {
+                return false;
+            }
+            stats.hiddenSingles++;
+            changed = true;
+        }
+    }
+
+    return true;
+}                         // end of hiddenSingles
+//==============================================================================
+
+//====lockedCandidates==========================================================
+// Description: Pointing: a digit confined to one row/column of a box is
+//              removed from the rest of that row/column. Claiming: a digit
+//              confined to one box of a row/column is removed from the rest
+//              of that box
+// Parameters: changed - set to true if any candidate was removed
+// Return: false on a contradiction
+//==============================================================================
+bool Propagator::lockedCandidates(bool &changed) {
+    long long before = stats.lockedCandidates;
+
+    for (int b = 0; b < 9; b++) {
+        int br = (b / 3) * 3;
+        int bc = (b % 3) * 3;
+        unsigned short rowPart[3] = {0, 0, 0};
+        unsigned short colPart[3] = {0, 0, 0};
+
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++) {
+                int cell = (br + i) * 9 + bc + j;
+                if (grid.value[cell] == 0) {
+                    rowPart[i] |= grid.cand[cell];
+                    colPart[j] |= grid.cand[cell];
+                }
+            }
+        }
+
+        for (int i = 0; i < 3; i++) {
+            // pointing along a row
+            unsigned short only = rowPart[i] & ~(rowPart[(i + 1) % 3] | rowPart[(i + 2) % 3]);
+            if (only) {
+                for (int y = 0; y < 9; y++) {
+                    if ((y < bc || y >= bc + 3) && !eliminate((br + i) * 9 + y, only)) {
+                        return false;
+                    }
+                }
+            }
+
+            // pointing along a column
+            only = colPart[i] & ~(colPart[(i + 1) % 3] | colPart[(i + 2) % 3]);
+            if (only) {
+                for (int x = 0; x < 9; x++) {
+                    if ((x < br || x >= br + 3) && !eliminate(x * 9 + bc + i, only)) {
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+
+    for (int line = 0; line < 9; line++) {
+        unsigned short rowSeg[3] = {0, 0, 0};
+        unsigned short colSeg[3] = {0, 0, 0};
+
+        for (int k = 0; k < 9; k++) {
+            int rowCell = line * 9 + k;
+            int colCell = k * 9 + line;
+            if (grid.value[rowCell] == 0) {
+                rowSeg[k / 3] |= grid.cand[rowCell];
+            }
+            if (grid.value[colCell] == 0) {
+                colSeg[k / 3] |= grid.cand[colCell];
+            }
+        }
+
+        for (int s = 0; s < 3; s++) {
+            // claiming from a row: clear the rest of box (line / 3, s)
+            unsigned short only = rowSeg[s] & ~(rowSeg[(s + 1) % 3] | rowSeg[(s + 2) % 3]);
+            if (only) {
+                int br = (line / 3) * 3;
+                for (int x = br; x < br + 3; x++) {
+                    for (int y = s * 3; y < s * 3 + 3; y++) {
+                        if (x != line && !eliminate(x * 9 + y, only)) {
+                            return false;
+                        }
+                    }
+                }
+            }
+
+            // claiming from a column: clear the rest of box (s, line / 3)
+            only = colSeg[s] & ~(colSeg[(s + 1) % 3] | colSeg[(s + 2) % 3]);
+            if (only) {
+                int bc = (line / 3) * 3;
+                for (int x = s * 3; x < s * 3 + 3; x++) {
+                    for (int y = bc; y < bc + 3; y++) {
+                        if (y != line && !eliminate(x * 9 + y, only)) {
+                            return false;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    if (stats.lockedCandidates != before) {
+        changed = true;
+    }
+
+    return true;
+}                         // end of lockedCandidates
+//==============================================================================
+
+//====propagate=================================================================
+// Description: Applies the rules, cheapest first, until none of them changes
+//              the board
+// Return: false if the board turned out to have no solution
+//==============================================================================
+bool Propagator::propagate() {
+    bool changed = true;
+
+    while (changed) {
+        changed = false;
+
+        if (!nakedSingles(changed)) {
+            return false;
+        }
+        if (changed) {
+            continue;
+        }
+
+        if (!hiddenSingles(changed)) {
+            return false;
+        }
+        if (changed) {
+            continue;
+        }
+
+        if (!lockedCandidates(changed)) {
+            return false;
+        }
+    }
+
+    return true;
+}                         // end of propagate
+//==============================================================================
+
+//====search====================================================================
+// Description: Propagates, then guesses on the empty cell with the fewest
+//              candidates and propagates again after every guess
+// Parameters: limit - stop once this many are found (0 counts them all)
+// Return: number of solutions
+//==============================================================================
+int Propagator::search(int limit) {
+    // another thread already has the answer
+    if (cancel && cancel->load(memory_order_relaxed)) {
+        return 0;
+    }
+
+    if (!propagate()) {
+        return 0;
+    }
+
+    int best = -1;
+    int bestCount = 10;
+    for (int cell = 0; cell < 81; cell++) {
+        if (grid.value[cell] == 0) {
+            int count = __builtin_popcount(grid.cand[cell]);
+            if (count < bestCount) {
+                best = cell;
+                bestCount = count;
+                if (count == 2) {
+                    break;
+                }
+            }
+        }
+    }
+
+    // no empty cells: solved
+    if (best < 0) {
+        if (recordSolution) {
+            for (int cell = 0; cell < 81; cell++) {
+                solution[cell / 9][cell % 9] = grid.value[cell];
+            }
+            recordSolution = false;
+        }
+        return 1;
+    }
+
+    int solutions = 0;
+    unsigned short open = grid.cand[best];
+    CandidateGrid saved = grid;
+
+    while (open) {
+        int num = __builtin_ctz(open) + 1;
+        open &= open - 1;
+        stats.guesses++;
+        depth++;
+        stats.maxDepth = max(stats.maxDepth, depth);
+
+        int found = assign(best, num) ? search(limit ? limit - solutions : 0) : 0;
+        if (found == 0) {
+            stats.backtracks++;
+        }
+        solutions += found;
+        grid = saved;
+        depth--;
+
+        if (limit && solutions >= limit) {
+            break;
+        }
+    }
+
+    return solutions;
+}                         // end of search
+//==============================================================================
+
+//====count=====================================================================
+// Description: Counts the solutions of the loaded board
+// Parameters: limit - stop once this many are found (0 counts them all)
+// Return: number of solutions
+//==============================================================================
+int Propagator::count(int limit) {
+    return search(limit);
+}                         // end of count
+//==============================================================================
+
+//====solve=====================================================================
+// Description: Fills in a board with its first solution
+// Parameters: board - packed 9x9 grid, 0 for empty cells; left as is if
+//             unsolvable
+// Return: true if a solution was found, false otherwise
+//==============================================================================
+bool Propagator::solve(PackedBoard &board) {
+    if (!load(board)) {
+        return false;
+    }
+
+    recordSolution = true;
+    if (search(1) == 0) {
+        recordSolution = false;
+        return false;
+    }
+
+    for (int x = 0; x < 9; x++) {
+        for (int y = 0; y < 9; y++) {
+            board.set(x, y, solution[x][y]);
+        }
+    }
+
+    return true;
+}                         // end of solve
+//==============================================================================
+
+//====getValue==================================================================
+// Description: Returns the number placed in a cell so far
+// Parameters: x - row, y - column
+// Return: number in the cell, 0 if it is still open
+//==============================================================================
+int Propagator::getValue(int x, int y) {
+    return grid.value[x * 9 + y];
+}                         // end of getValue
+//==============================================================================
+
+//====exclude===================================================================
+// Description: Rules a number out of an empty cell, so the next count only
+//              finds solutions with something else there
+// Parameters: x - row, y - column, num - number to rule out
+// Return: false if the cell is left with no candidates
+//==============================================================================
+bool Propagator::exclude(int x, int y, int num) {
+    return eliminate(x * 9 + y, 1 << (num - 1));
+}                         // end of exclude
+//==============================================================================
+
+//====getStats==================================================================
+// Description: Returns what each rule did since the last load
+// Return: propagation counters
+//==============================================================================
+PropagationStats Propagator::getStats() {
+    return stats;
+}                         // end of getStats
+//==============================================================================
+
+//====setCancelFlag=============================================================
+// Description: Sets a flag that makes a running search give up once set
+// Parameters: flag - cancel flag, or nullptr to never stop early
+//==============================================================================
+void Propagator::setCancelFlag(const atomic<bool> *flag) {
+    this->cancel = flag;
+}                         // end of setCancelFlag
+//==============================================================================
+
+#endif
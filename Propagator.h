@@ -0,0 +1,55 @@
+// Propagator.h - header file
+
+#include <atomic>
+#include <mutex>
+using namespace std;
+
+// How much of the work each propagation rule did
+struct PropagationStats {
+    long long nakedSingles;         // cells with one candidate left
+    long long hiddenSingles;        // digits with one place left in a unit
+    long long lockedCandidates;     // candidates removed by pointing/claiming
+    long long guesses;              // branches tried once propagation stalled
+    long long backtracks;           // guesses whose subtree had no solution
+    int maxDepth;                   // most guesses on the stack at once
+};
+
+// Candidate state of a whole board, copied on every guess
+struct CandidateGrid {
+    unsigned short cand[81];        // bit (num - 1) set if num is a candidate
+    unsigned char value[81];        // placed number, 0 if empty
+};
+
+class Propagator {
+private:
+    CandidateGrid grid;
+    PropagationStats stats;
+    int depth;                      // guesses on the stack
+    bool recordSolution;
+    int solution[9][9];
+    const atomic<bool> *cancel;     // stop searching once set
+
+    static once_flag tablesBuilt;
+
+    bool assign(int cell, int num);
+    bool eliminate(int cell, unsigned short bits);
+    bool nakedSingles(bool &changed);
+    bool hiddenSingles(bool &changed);
+    bool lockedCandidates(bool &changed);
+    int search(int limit);
+
+public:
+    static int units[27][9];        // rows, then columns, then boxes
+    static int peers[81][20];
+
+    static void buildTables();
+    Propagator();
+    bool load(const PackedBoard &board);
+    bool propagate();
+    int count(int limit);
+    bool solve(PackedBoard &board);
+    int getValue(int x, int y);
+    bool exclude(int x, int y, int num);
+    PropagationStats getStats();
+    void setCancelFlag(const atomic<bool> *flag);
+};
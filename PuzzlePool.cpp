@@ -0,0 +1,184 @@
+// PuzzlePool.cpp - implementation file
+#ifndef PUZZLEPOOL_H
+#define PUZZLEPOOL_H
+
+#include "Sudoku.cpp"
+#include "PuzzlePool.h"
+#include <chrono>
+using namespace std;
+
+// Constructor: starts the workers, which fill every queue right away
+PuzzlePool::PuzzlePool(int threads, int perLevel) {
+    if (threads < 1) {
+        threads = 1;
+    }
+
+    this->capacity = perLevel < 1 ? 1 : perLevel;
+    this->stopping = false;
+
+    for (int i = 0; i < LEVELS; i++) {
+        levels[i].inFlight = 0;
+        levels[i].generated = 0;
+        levels[i].taken = 0;
+        levels[i].misses = 0;
+        levels[i].busyNanos = 0;
+    }
+    for (int i = 0; i < threads; i++) {
+        solvers.push_back(unique_ptr<Sudoku>(new Sudoku()));
+        solvers[i]->setCancelFlag(&stopping);
+    }
+    for (int i = 0; i < threads; i++) {
+        workers.push_back(thread(&PuzzlePool::run, this, i));
+    }
+}
+
+// Destructor: stops and joins the workers
+PuzzlePool::~PuzzlePool() {
+    stop();
+}
+
+//====stop======================================================================
+// Description: Stops the workers and waits for them to exit. A puzzle being
+//              generated is cancelled and thrown away. Safe to call twice
+//==============================================================================
+void PuzzlePool::stop() {
+    {
+        lock_guard<mutex> guard(stateLock);
+        stopping = true;
+    }
+    space.notify_all();
+
+    for (thread &worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}                         // end of stop
+//==============================================================================
+
+//====neediest==================================================================
+// Description: Picks the level with the fewest puzzles ready or on the way;
+//              the caller holds stateLock
+// Return: level, or -1 if every queue is full
+//==============================================================================
+int PuzzlePool::neediest() {
+    int best = -1;
+    int bestCount = capacity;
+
+    for (int i = 0; i < LEVELS; i++) {
+        int count = (int) levels[i].ready.size() + levels[i].inFlight;
+        if (count < bestCount) {
+            best = i;
+            bestCount = count;
+        }
+    }
+
+    return best;
+}                         // end of neediest
+//==============================================================================
+
+//====run=======================================================================
+// Description: Worker loop: sleeps until a queue has room, generates a
+//              puzzle for it outside the lock, then queues it
+// Parameters: id - worker index
+//==============================================================================
+void PuzzlePool::run(int id) {
+    Sudoku &solver = *solvers[id];
+    unique_lock<mutex> guard(stateLock);
+
+    while (true) {
+        int level = -1;
+        space.wait(guard, [&] {
+            return stopping || (level = neediest()) != -1;
+        });
+        if (stopping) {
+            return;
+        }
+
+        levels[level].inFlight++;
+        guard.unlock();
+
+        auto start = chrono::steady_clock::now();
+        solver.setDifficulty(level);
+        bool generated = solver.generateBoard();
+        ReadyPuzzle made = {solver.snapshot(), solver.getSolution(), solver.getSeed(),
+                            solver.getPuzzleId()};
+        long long ns = chrono::duration_cast<chrono::nanoseconds>(
+            chrono::steady_clock::now() - start).count();
+
+        guard.lock();
+        levels[level].inFlight--;
+        if (stopping) {
+            return;
+        }
+        if (!generated) {
+            continue;   // never queue a puzzle outside its rating band
+        }
+        levels[level].ready.push_back(made);
+        levels[level].generated++;
+        levels[level].busyNanos += ns;
+    }
+}                         // end of run
+//==============================================================================
+
+//====take======================================================================
+// Description: Loads a ready puzzle of a difficulty into a game. When the
+//              queue is empty it falls back to generating one in place
+// Parameters: game - gets the puzzle and its difficulty, level - 0-2
+// Return: true if the puzzle came from the queue
+//==============================================================================
+bool PuzzlePool::take(Sudoku &game, int level) {
+    if (level < 0 || level >= LEVELS) {
+        return false;
+    }
+    game.setDifficulty(level);
+
+    ReadyPuzzle next;
+    bool found = false;
+    {
+        lock_guard<mutex> guard(stateLock);
+        if (levels[level].ready.empty()) {
+            levels[level].misses++;
+        } else {
+            next = levels[level].ready.front();
+            levels[level].ready.pop_front();
+            levels[level].taken++;
+            found = true;
+        }
+    }
+
+    if (!found) {
+        game.generateBoard();
+        return false;
+    }
+
+    space.notify_one();
+    game.loadPuzzle(next.puzzle, next.solution, next.seed, next.id);
+    return true;
+}                         // end of take
+//==============================================================================
+
+//====getMetrics================================================================
+// Description: Reads a difficulty's queue depth and refill counters
+// Parameters: level - 0-2
+// Return: snapshot of the counters
+//==============================================================================
+PoolMetrics PuzzlePool::getMetrics(int level) {
+    lock_guard<mutex> guard(stateLock);
+    const LevelQueue &queue = levels[level];
+    PoolMetrics metrics;
+
+    metrics.depth = (int) queue.ready.size();
+    metrics.capacity = capacity;
+    metrics.inFlight = queue.inFlight;
+    metrics.generated = queue.generated;
+    metrics.taken = queue.taken;
+    metrics.misses = queue.misses;
+    metrics.busyNanos = queue.busyNanos;
+    metrics.refillRate = queue.busyNanos > 0 ? queue.generated * 1e9 / queue.busyNanos : 0;
+
+    return metrics;
+}                         // end of getMetrics
+//==============================================================================
+
+#endif
@@ -0,0 +1,66 @@
+// PuzzlePool.h - header file
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <string>
+using namespace std;
+
+// Snapshot of one difficulty's ready-queue
+struct PoolMetrics {
+    int depth;                      // puzzles ready to take
+    int capacity;                   // most puzzles kept ready
+    int inFlight;                   // puzzles being generated right now
+    long long generated;            // puzzles the workers added
+    long long taken;                // puzzles handed out from the queue
+    long long misses;               // takes that found the queue empty
+    long long busyNanos;            // worker time spent generating
+    double refillRate;              // puzzles per second of worker time
+};
+
+// Keeps a bounded queue of finished puzzles for each difficulty, refilled
+// by background threads, so taking a puzzle doesn't wait on the generator.
+// Each worker has its own Sudoku seeded from the system's entropy source
+class PuzzlePool {
+private:
+    static const int LEVELS = 3;
+
+    struct ReadyPuzzle {
+        PackedBoard puzzle;
+        PackedBoard solution;
+        uint64_t seed;
+        string id;
+    };
+
+    struct LevelQueue {
+        deque<ReadyPuzzle> ready;
+        int inFlight;
+        long long generated;
+        long long taken;
+        long long misses;
+        long long busyNanos;
+    };
+
+    LevelQueue levels[LEVELS];
+    int capacity;
+    vector<thread> workers;
+    vector<unique_ptr<Sudoku>> solvers;     // one per worker
+    mutex stateLock;
+    condition_variable space;               // a queue has room, or stopping
+    atomic<bool> stopping;                  // also cancels searches running
+
+    int neediest();
+    void run(int id);
+
+public:
+    PuzzlePool(int threads, int perLevel);
+    ~PuzzlePool();
+    bool take(Sudoku &game, int level);
+    PoolMetrics getMetrics(int level);
+    void stop();
+};
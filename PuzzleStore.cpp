@@ -0,0 +1,212 @@
+// PuzzleStore.cpp - implementation file
+#ifndef PUZZLESTORE_H
+#define PUZZLESTORE_H
+
+#include "PackedBoard.h"
+#include "Random.h"
+#include "PuzzleStore.h"
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+using namespace std;
+
+static const char STORE_MAGIC[8] = {'S', 'U', 'D', 'O', 'K', 'U', 'D', 'B'};
+
+//====packRecord================================================================
+// Description: Fills a record from a puzzle and its solution. The canonical
+//              hash and rating are left for the caller
+// Parameters: puzzle - givens, solution - solved grid, level - 0-2,
+//             record - receives the packed puzzle
+//==============================================================================
+void packRecord(const PackedBoard &puzzle, const PackedBoard &solution, int level, PuzzleRecord &record) {
+    memset(&record, 0, sizeof(record));
+
+    for (int i = 0; i < 81; i++) {
+        record.clues[i] = puzzle.cells[i];
+        record.solution[i >> 1] |= solution.cells[i] << ((i & 1) * 4);
+    }
+    record.level = level;
+}                         // end of packRecord
+//==============================================================================
+
+//====unpackRecord==============================================================
+// Description: Expands a record into boards; the clues become the givens
+// Parameters: record - stored puzzle, puzzle - receives the givens,
+//             solution - receives the solved grid
+//==============================================================================
+void unpackRecord(const PuzzleRecord &record, PackedBoard &puzzle, PackedBoard &solution) {
+    for (int i = 0; i < 81; i++) {
+        puzzle.cells[i] = record.clues[i];
+        solution.cells[i] = (record.solution[i >> 1] >> ((i & 1) * 4)) & 0xF;
+    }
+    puzzle.markGivens();
+    solution.givens[0] = puzzle.givens[0];
+    solution.givens[1] = puzzle.givens[1];
+}                         // end of unpackRecord
+//==============================================================================
+
+//====writePuzzleStore==========================================================
+// Description: Writes a store file: header, then the records grouped by
+//              level
+// Parameters: path - file to create, records - puzzles; sorted in place
+// Return: true if the file was written, false on an I/O error
+//==============================================================================
+bool writePuzzleStore(const char *path, vector<PuzzleRecord> &records) {
+    stable_sort(records.begin(), records.end(), [](const PuzzleRecord &a, const PuzzleRecord &b) {
+        return a.level < b.level;
+    });
+
+    StoreHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, STORE_MAGIC, sizeof(STORE_MAGIC));
+    header.version = STORE_VERSION;
+    header.recordSize = sizeof(PuzzleRecord);
+    for (const PuzzleRecord &record : records) {
+        header.levelCount[record.level]++;
+    }
+    for (int level = 1; level < STORE_LEVELS; level++) {
+        header.levelOffset[level] = header.levelOffset[level - 1] + header.levelCount[level - 1];
+    }
+
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        return false;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    if (ok && !records.empty()) {
+        ok = fwrite(records.data(), sizeof(PuzzleRecord), records.size(), file) == records.size();
+    }
+    ok = fclose(file) == 0 && ok;
+
+    return ok;
+}                         // end of writePuzzleStore
+//==============================================================================
+
+// Constructor
+PuzzleStore::PuzzleStore() {
+    this->data = nullptr;
+    this->length = 0;
+    this->header = nullptr;
+    this->records = nullptr;
+}
+
+// Destructor
+PuzzleStore::~PuzzleStore() {
+    close();
+}
+
+//====open======================================================================
+// Description: Maps a store file and checks its header and size
+// Parameters: path - store file
+// Return: true if the store is ready, false if it is missing or malformed
+//==============================================================================
+bool PuzzleStore::open(const char *path) {
+    close();
+
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t) info.st_size < sizeof(StoreHeader)) {
+        ::close(fd);
+        return false;
+    }
+
+    void *map = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+    data = (const unsigned char *) map;
+    length = info.st_size;
+    header = (const StoreHeader *) data;
+    records = (const PuzzleRecord *) (data + sizeof(StoreHeader));
+
+    // the records must be exactly the ones the index describes
+    uint64_t total = 0;
+    bool ok = !memcmp(header->magic, STORE_MAGIC, sizeof(STORE_MAGIC))
+              && header->version == STORE_VERSION
+              && header->recordSize == sizeof(PuzzleRecord);
+    for (int level = 0; ok && level < STORE_LEVELS; level++) {
+        ok = header->levelOffset[level] == total;
+        total += header->levelCount[level];
+    }
+    if (!ok || length != sizeof(StoreHeader) + total * sizeof(PuzzleRecord)) {
+        close();
+        return false;
+    }
+
+    return true;
+}                         // end of open
+//==============================================================================
+
+//====close=====================================================================
+// Description: Unmaps the file, if one is open
+//==============================================================================
+void PuzzleStore::close() {
+    if (data) {
+        munmap((void *) data, length);
+    }
+    data = nullptr;
+    length = 0;
+    header = nullptr;
+    records = nullptr;
+}                         // end of close
+//==============================================================================
+
+//====isOpen====================================================================
+// Description: Checks whether a store is mapped
+// Return: true if open succeeded
+//==============================================================================
+bool PuzzleStore::isOpen() const {
+    return data != nullptr;
+}                         // end of isOpen
+//==============================================================================
+
+//====count=====================================================================
+// Description: Returns how many puzzles a level holds
+// Parameters: level - 0 EASY, 1 MEDIUM, 2 HARD
+// Return: number of puzzles, 0 if the store is closed
+//==============================================================================
+long long PuzzleStore::count(int level) const {
+    if (!header || level < 0 || level >= STORE_LEVELS) {
+        return 0;
+    }
+    return header->levelCount[level];
+}                         // end of count
+//==============================================================================
+
+//====get=======================================================================
+// Description: Returns one puzzle of a level
+// Parameters: level - 0-2, index - position within the level
+// Return: the record, or nullptr if out of range
+//==============================================================================
+const PuzzleRecord *PuzzleStore::get(int level, long long index) const {
+    if (index < 0 || index >= count(level)) {
+        return nullptr;
+    }
+    return records + header->levelOffset[level] + index;
+}                         // end of get
+//==============================================================================
+
+//====random====================================================================
+// Description: Returns a random puzzle of a level
+// Parameters: level - 0-2, rng - random stream
+// Return: the record, or nullptr if the level is empty
+//==============================================================================
+const PuzzleRecord *PuzzleStore::random(int level, Random &rng) const {
+    long long n = count(level);
+    if (n == 0) {
+        return nullptr;
+    }
+    return get(level, (long long) rng.below(n));
+}                         // end of random
+//==============================================================================
+
+#endif // PUZZLESTORE_H
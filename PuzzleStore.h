@@ -0,0 +1,58 @@
+// PuzzleStore.h - header file
+
+#include <cstdint>
+#include <vector>
+using namespace std;
+
+const uint32_t STORE_VERSION = 1;
+const int STORE_LEVELS = 3;                 // EASY, MEDIUM, HARD
+
+// File header. The records follow it, sorted by level, so each level is one
+// contiguous run starting at levelOffset
+struct StoreHeader {
+    char magic[8];                          // "SUDOKUDB"
+    uint32_t version;                       // STORE_VERSION
+    uint32_t recordSize;                    // sizeof(PuzzleRecord)
+    uint64_t levelOffset[STORE_LEVELS];     // first record of each level
+    uint64_t levelCount[STORE_LEVELS];      // records of each level
+};
+
+// One puzzle, fixed width. Multi-byte fields are stored in host byte order
+struct PuzzleRecord {
+    uint64_t canonHash;                     // canonicalHash of the minlex form
+    unsigned char clues[81];                // 0 for blank, 1-9 for a given
+    unsigned char solution[41];             // two cells per byte, low nibble first
+    unsigned char level;                    // 0 EASY, 1 MEDIUM, 2 HARD
+    unsigned char reserved;
+    uint16_t rating;                        // 0 if unrated
+};
+
+static_assert(sizeof(StoreHeader) == 64, "StoreHeader layout");
+static_assert(sizeof(PuzzleRecord) == 136, "PuzzleRecord layout");
+
+void packRecord(const PackedBoard &puzzle, const PackedBoard &solution, int level, PuzzleRecord &record);
+void unpackRecord(const PuzzleRecord &record, PackedBoard &puzzle, PackedBoard &solution);
+bool writePuzzleStore(const char *path, vector<PuzzleRecord> &records);
+
+// Read-only view of a store file, mapped into memory: opening it costs one
+// mmap and a header check, however many puzzles it holds
+class PuzzleStore {
+private:
+    const unsigned char *data;              // whole file
+    size_t length;
+    const StoreHeader *header;
+    const PuzzleRecord *records;
+
+    void close();
+
+public:
+    PuzzleStore();
+    ~PuzzleStore();
+    PuzzleStore(const PuzzleStore &) = delete;
+    PuzzleStore &operator=(const PuzzleStore &) = delete;
+    bool open(const char *path);
+    bool isOpen() const;
+    long long count(int level) const;
+    const PuzzleRecord *get(int level, long long index) const;
+    const PuzzleRecord *random(int level, Random &rng) const;
+};
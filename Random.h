@@ -0,0 +1,97 @@
+// Random.h - seedable random number stream
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstdint>
+#include <random>
+using namespace std;
+
+// xoshiro256** generator seeded through splitmix64. The same seed gives the
+// same numbers on every platform: below() and shuffle() are done here
+// rather than with the standard distributions, whose output is up to the
+// library
+class Random {
+private:
+    uint64_t state[4];
+
+    static uint64_t rotl(uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+public:
+    typedef uint64_t result_type;
+
+    explicit Random(uint64_t seed = 0) {
+        reseed(seed);
+    }
+
+    // Restarts the stream from a seed
+    void reseed(uint64_t seed) {
+        for (int i = 0; i < 4; i++) {
+            seed += 0x9E3779B97F4A7C15ULL;
+            uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            state[i] = z ^ (z >> 31);
+        }
+    }
+
+    uint64_t next() {
+        uint64_t result = rotl(state[1] * 5, 7) * 9;
+        uint64_t t = state[1] << 17;
+
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+
+        return result;
+    }
+
+    uint64_t operator()() {
+        return next();
+    }
+
+    static constexpr uint64_t min() {
+        return 0;
+    }
+
+    static constexpr uint64_t max() {
+        return UINT64_MAX;
+    }
+
+    // Uniform number in [0, n), n > 0 (Lemire's multiply-and-reject)
+    uint64_t below(uint64_t n) {
+        unsigned __int128 m = (unsigned __int128) next() * n;
+        uint64_t low = (uint64_t) m;
+        if (low < n) {
+            uint64_t threshold = -n % n;
+            while (low < threshold) {
+                m = (unsigned __int128) next() * n;
+                low = (uint64_t) m;
+            }
+        }
+        return (uint64_t) (m >> 64);
+    }
+
+    // Fisher-Yates shuffle of count elements
+    template <class T>
+    void shuffle(T *first, int count) {
+        for (int i = count - 1; i > 0; i--) {
+            int j = (int) below(i + 1);
+            T temp = first[i];
+            first[i] = first[j];
+            first[j] = temp;
+        }
+    }
+
+    // Fresh seed from the system's entropy source
+    static uint64_t entropy() {
+        random_device rd;
+        return ((uint64_t) rd() << 32) ^ rd();
+    }
+};
+
+#endif // RANDOM_H
@@ -0,0 +1,548 @@
+// Rater.cpp - implementation file
+#ifndef RATER_H
+#define RATER_H
+
+#include "Propagator.cpp"
+#include "Rater.h"
+#include <cstring>
+using namespace std;
+
+// Difficulty weight of each technique, roughly on the Sudoku Explainer scale
+// (x10). Guessing sits far above everything else
+const int Rater::WEIGHTS[TECHNIQUES] = {10, 15, 26, 30, 32, 34, 36, 38, 40, 42, 100};
+
+static const char *const TECHNIQUE_NAMES[TECHNIQUES] = {
+    "naked single", "hidden single", "locked candidates", "naked pair", "x-wing",
+    "hidden pair", "naked triple", "swordfish", "hidden triple", "xy-wing", "guess"
+};
+
+// Constructor
+Rater::Rater() {
+    Propagator::buildTables();
+    this->empty = 0;
+}
+
+//====place=====================================================================
+// Description: Places a number and removes it from the cell's peers
+// Parameters: cell - index 0-80, num - number to place
+//==============================================================================
+void Rater::place(int cell, int num) {
+    unsigned short bit = 1 << (num - 1);
+
+    grid.value[cell] = num;
+    grid.cand[cell] = bit;
+    empty--;
+
+    for (int i = 0; i < 20; i++) {
+        int p = Propagator::peers[cell][i];
+        if (grid.value[p] == 0) {
+            grid.cand[p] &= ~bit;
+        }
+    }
+}                         // end of place
+//==============================================================================
+
+//====remove====================================================================
+// Description: Removes candidates from an empty cell
+// Parameters: cell - index 0-80, bits - candidates to remove
+// Return: true if any candidate was removed
+//==============================================================================
+bool Rater::remove(int cell, unsigned short bits) {
+    if (grid.value[cell] != 0 || !(grid.cand[cell] & bits)) {
+        return false;
+    }
+
+    grid.cand[cell] &= ~bits;
+    return true;
+}                         // end of remove
+//==============================================================================
+
+//====nakedSingles==============================================================
+// Description: Places every empty cell that has one candidate left
+// Return: number of cells placed
+//==============================================================================
+int Rater::nakedSingles() {
+    int found = 0;
+
+    for (int cell = 0; cell < 81; cell++) {
+        unsigned short open = grid.cand[cell];
+        if (grid.value[cell] == 0 && open && (open & (open - 1)) == 0) {
+            place(cell, __builtin_ctz(open) + 1);
+            found++;
+        }
+    }
+
+    return found;
+}                         // end of nakedSingles
+//==============================================================================
+
+//====hiddenSingles=============================================================
+// Description: Places every digit that fits in only one cell of a unit
+// Return: number of cells placed
+//==============================================================================
+int Rater::hiddenSingles() {
+    int found = 0;
+
+    for (int u = 0; u < 27; u++) {
+        unsigned short once = 0;
+        unsigned short twice = 0;
+
+        for (int i = 0; i < 9; i++) {
+            int cell = Propagator::units[u][i];
+            if (grid.value[cell] == 0) {
+                twice |= once & grid.cand[cell];
+                once |= grid.cand[cell];
+            }
+        }
+
+        unsigned short single = once & ~twice;
+        for (int i = 0; single && i < 9; i++) {
+            int cell = Propagator::units[u][i];
+            unsigned short bit = grid.cand[cell] & single;
+            if (grid.value[cell] == 0 && bit) {
+                bit &= -bit;
+                single &= ~bit;
+                place(cell, __builtin_ctz(bit) + 1);
+                found++;
+            }
+        }
+    }
+
+    return found;
+}                         // end of hiddenSingles
+//==============================================================================
+
+//====lockedCandidates==========================================================
+// Description: Pointing and claiming: a digit confined to the overlap of a
+//              box and a row/column is removed from the rest of the other
+// Return: number of box/line overlaps that removed something
+//==============================================================================
+int Rater::lockedCandidates() {
+    int found = 0;
+
+    for (int box = 18; box < 27; box++) {
+        for (int line = 0; line < 18; line++) {
+            // cells of the box that are also in the line
+            unsigned short inside = 0;
+            unsigned short boxRest = 0;
+            unsigned short lineRest = 0;
+            bool overlap = false;
+
+            for (int i = 0; i < 9; i++) {
+                int cell = Propagator::units[box][i];
+                bool shared = line < 9 ? cell / 9 == line : cell % 9 == line - 9;
+                overlap |= shared;
+                if (grid.value[cell] == 0) {
+                    if (shared) {
+                        inside |= grid.cand[cell];
+                    } else {
+                        boxRest |= grid.cand[cell];
+                    }
+                }
+            }
+            if (!overlap) {
+                continue;
+            }
+
+            for (int i = 0; i < 9; i++) {
+                int cell = Propagator::units[line][i];
+                bool shared = (cell / 9) / 3 * 3 + (cell % 9) / 3 == box - 18;
+                if (grid.value[cell] == 0 && !shared) {
+                    lineRest |= grid.cand[cell];
+                }
+            }
+
+            // pointing clears the line, claiming clears the box
+            unsigned short pointing = inside & ~boxRest & lineRest;
+            unsigned short claiming = inside & ~lineRest & boxRest;
+            bool progress = false;
+
+            for (int i = 0; i < 9; i++) {
+                int lineCell = Propagator::units[line][i];
+                int boxCell = Propagator::units[box][i];
+                if ((lineCell / 9) / 3 * 3 + (lineCell % 9) / 3 != box - 18) {
+                    progress |= remove(lineCell, pointing);
+                }
+                bool shared = line < 9 ? boxCell / 9 == line : boxCell % 9 == line - 9;
+                if (!shared) {
+                    progress |= remove(boxCell, claiming);
+                }
+            }
+            found += progress;
+        }
+    }
+
+    return found;
+}                         // end of lockedCandidates
+//==============================================================================
+
+//====nakedSubsets==============================================================
+// Description: Naked pairs/triples: size cells of a unit sharing exactly
+//              size candidates take those digits from the rest of the unit
+// Parameters: size - 2 or 3
+// Return: number of subsets that removed something
+//==============================================================================
+int Rater::nakedSubsets(int size) {
+    int found = 0;
+
+    for (int u = 0; u < 27; u++) {
+        int cells[9];
+        int count = 0;
+        for (int i = 0; i < 9; i++) {
+            int cell = Propagator::units[u][i];
+            int n = __builtin_popcount(grid.cand[cell]);
+            if (grid.value[cell] == 0 && n >= 2 && n <= size) {
+                cells[count++] = i;
+            }
+        }
+
+        // every choice of size cells, as a bitmask over cells[]
+        for (int pick = 0; pick < (1 << count); pick++) {
+            if (__builtin_popcount(pick) != size) {
+                continue;
+            }
+
+            unsigned short members = 0;
+            unsigned short digits = 0;
+            for (int k = 0; k < count; k++) {
+                if (pick & (1 << k)) {
+                    members |= 1 << cells[k];
+                    digits |= grid.cand[Propagator::units[u][cells[k]]];
+                }
+            }
+            if (__builtin_popcount(digits) != size) {
+                continue;
+            }
+
+            bool progress = false;
+            for (int i = 0; i < 9; i++) {
+                if (!(members & (1 << i))) {
+                    progress |= remove(Propagator::units[u][i], digits);
+                }
+            }
+            found += progress;
+        }
+    }
+
+    return found;
+}                         // end of nakedSubsets
+//==============================================================================
+
+//====hiddenSubsets=============================================================
+// Description: Hidden pairs/triples: size digits confined to the same size
+//              cells of a unit clear every other candidate from those cells
+// Parameters: size - 2 or 3
+// Return: number of subsets that removed something
+//==============================================================================
+int Rater::hiddenSubsets(int size) {
+    int found = 0;
+
+    for (int u = 0; u < 27; u++) {
+        // where each digit can still go, as unit positions
+        unsigned short where[9] = {0};
+        for (int i = 0; i < 9; i++) {
+            int cell = Propagator::units[u][i];
+            if (grid.value[cell] == 0) {
+                for (unsigned short open = grid.cand[cell]; open; open &= open - 1) {
+                    where[__builtin_ctz(open)] |= 1 << i;
+                }
+            }
+        }
+
+        int digits[9];
+        int count = 0;
+        for (int d = 0; d < 9; d++) {
+            int n = __builtin_popcount(where[d]);
+            if (n >= 2 && n <= size) {
+                digits[count++] = d;
+            }
+        }
+
+        // every choice of size digits, as a bitmask over digits[]
+        for (int pick = 0; pick < (1 << count); pick++) {
+            if (__builtin_popcount(pick) != size) {
+                continue;
+            }
+
+            unsigned short keep = 0;
+            unsigned short cells = 0;
+            for (int k = 0; k < count; k++) {
+                if (pick & (1 << k)) {
+                    keep |= 1 << digits[k];
+                    cells |= where[digits[k]];
+                }
+            }
+            if (__builtin_popcount(cells) != size) {
+                continue;
+            }
+
+            bool progress = false;
+            for (int i = 0; i < 9; i++) {
+                if (cells & (1 << i)) {
+                    progress |= remove(Propagator::units[u][i], ~keep & 0x1FF);
+                }
+            }
+            found += progress;
+        }
+    }
+
+    return found;
+}                         // end of hiddenSubsets
+//==============================================================================
+
+//====fish======================================================================
+// Description: X-wing (size 2) and swordfish (size 3): a digit confined to
+//              the same size columns in size rows is removed from the rest of
+//              those columns, and the same with rows and columns swapped
+// Parameters: size - 2 or 3
+// Return: number of patterns that removed something
+//==============================================================================
+int Rater::fish(int size) {
+    int found = 0;
+
+    for (int d = 0; d < 9; d++) {
+        unsigned short bit = 1 << d;
+
+        for (int base = 0; base < 2; base++) {
+            // per line, the cross lines the digit can still use
+            unsigned short where[9] = {0};
+            for (int line = 0; line < 9; line++) {
+                for (int k = 0; k < 9; k++) {
+                    int cell = base == 0 ? line * 9 + k : k * 9 + line;
+                    if (grid.value[cell] == 0 && (grid.cand[cell] & bit)) {
+                        where[line] |= 1 << k;
+                    }
+                }
+            }
+
+            int lines[9];
+            int count = 0;
+            for (int line = 0; line < 9; line++) {
+                int n = __builtin_popcount(where[line]);
+                if (n >= 2 && n <= size) {
+                    lines[count++] = line;
+                }
+            }
+
+            // every choice of size base lines, as a bitmask over lines[]
+            for (int pick = 0; pick < (1 << count); pick++) {
+                if (__builtin_popcount(pick) != size) {
+                    continue;
+                }
+
+                unsigned short members = 0;
+                unsigned short cross = 0;
+                for (int k = 0; k < count; k++) {
+                    if (pick & (1 << k)) {
+                        members |= 1 << lines[k];
+                        cross |= where[lines[k]];
+                    }
+                }
+                if (__builtin_popcount(cross) != size) {
+                    continue;
+                }
+
+                bool progress = false;
+                for (int line = 0; line < 9; line++) {
+                    if (members & (1 << line)) {
+                        continue;
+                    }
+                    for (int k = 0; k < 9; k++) {
+                        if (cross & (1 << k)) {
+                            int cell = base == 0 ? line * 9 + k : k * 9 + line;
+                            progress |= remove(cell, bit);
+                        }
+                    }
+                }
+                found += progress;
+            }
+        }
+    }
+
+    return found;
+}                         // end of fish
+//==============================================================================
+
+//====xyWing====================================================================
+// Description: A two-candidate pivot {a,b} seeing pincers {a,c} and {b,c}:
+//              c is removed from every cell that sees both pincers
+// Return: number of wings that removed something
+//==============================================================================
+int Rater::xyWing() {
+    int found = 0;
+
+    for (int pivot = 0; pivot < 81; pivot++) {
+        unsigned short pair = grid.cand[pivot];
+        if (grid.value[pivot] != 0 || __builtin_popcount(pair) != 2) {
+            continue;
+        }
+
+        for (int i = 0; i < 20; i++) {
+            int first = Propagator::peers[pivot][i];
+            unsigned short one = grid.cand[first];
+            if (grid.value[first] != 0 || __builtin_popcount(one) != 2
+                || __builtin_popcount(one & pair) != 1) {
+                continue;
+            }
+
+            for (int j = i + 1; j < 20; j++) {
+                int second = Propagator::peers[pivot][j];
+                unsigned short two = grid.cand[second];
+                unsigned short shared = one & ~pair;
+                if (grid.value[second] != 0 || __builtin_popcount(two) != 2
+                    || two != ((pair & ~one) | shared)) {
+                    continue;
+                }
+
+                // cells seeing both pincers lose the shared digit
+                bool progress = false;
+                for (int k = 0; k < 20; k++) {
+                    int cell = Propagator::peers[first][k];
+                    if (cell == second) {
+                        continue;
+                    }
+                    for (int m = 0; m < 20; m++) {
+                        if (Propagator::peers[second][m] == cell) {
+                            progress |= remove(cell, shared);
+                            break;
+                        }
+                    }
+                }
+                found += progress;
+            }
+        }
+    }
+
+    return found;
+}                         // end of xyWing
+//==============================================================================
+
+//====guess=====================================================================
+// Description: Stands in for trial and error: places the solution digit of
+//              the empty cell with the fewest candidates
+// Return: 1
+//==============================================================================
+int Rater::guess() {
+    int best = -1;
+    int bestCount = 10;
+
+    for (int cell = 0; cell < 81; cell++) {
+        int count = __builtin_popcount(grid.cand[cell]);
+        if (grid.value[cell] == 0 && count < bestCount) {
+            best = cell;
+            bestCount = count;
+        }
+    }
+
+    place(best, solution[best / 9][best % 9]);
+    return 1;
+}                         // end of guess
+//==============================================================================
+
+//====apply=====================================================================
+// Description: Runs one technique over the whole board
+// Parameters: technique - Technique to run
+// Return: number of times it made progress
+//==============================================================================
+int Rater::apply(int technique) {
+    switch (technique) {
+        case NAKED_SINGLE:
+            return nakedSingles();
+        case HIDDEN_SINGLE:
+            return hiddenSingles();
+        case LOCKED_CANDIDATES:
+            return lockedCandidates();
+        case NAKED_PAIR:
+            return nakedSubsets(2);
+        case X_WING:
+            return fish(2);
+        case HIDDEN_PAIR:
+            return hiddenSubsets(2);
+        case NAKED_TRIPLE:
+            return nakedSubsets(3);
+        case SWORDFISH:
+            return fish(3);
+        case HIDDEN_TRIPLE:
+            return hiddenSubsets(3);
+        case XY_WING:
+            return xyWing();
+        default:
+            return guess();
+    }
+}                         // end of apply
+//==============================================================================
+
+//====rate======================================================================
+// Description: Solves a puzzle the way a person would, always with the
+//              easiest technique that makes progress, and scores it by the
+//              hardest technique it needed and how often that one was used
+// Parameters: board - puzzle with a unique solution, rating - receives the
+//             result
+// Return: false if the board has no solution
+//==============================================================================
+bool Rater::rate(const PackedBoard &board, Rating &rating) {
+    memset(&rating, 0, sizeof(rating));
+
+    // the solution is only needed to guess right when logic runs out
+    PackedBoard solved = board;
+    Propagator solver;
+    if (!solver.solve(solved)) {
+        return false;
+    }
+    for (int cell = 0; cell < 81; cell++) {
+        solution[cell / 9][cell % 9] = solved.cells[cell];
+        grid.cand[cell] = 0x1FF;
+        grid.value[cell] = 0;
+    }
+
+    empty = 81;
+    for (int cell = 0; cell < 81; cell++) {
+        if (board.cells[cell]) {
+            place(cell, board.cells[cell]);
+        }
+    }
+
+    while (empty > 0) {
+        for (int technique = 0; technique < TECHNIQUES; technique++) {
+            int progress = apply(technique);
+            if (progress) {
+                rating.uses[technique] += progress;
+                rating.hardest = max(rating.hardest, technique);
+                break;
+            }
+        }
+    }
+
+    rating.score = WEIGHTS[rating.hardest] * 100 + min(99, rating.uses[rating.hardest]);
+    return true;
+}                         // end of rate
+//==============================================================================
+
+//====ratingLevel===============================================================
+// Description: Maps a score to a level: singles only are EASY, up to
+//              triples and x-wings MEDIUM, anything harder HARD
+// Parameters: score - Rating score
+// Return: 0 (EASY), 1 (MEDIUM) or 2 (HARD)
+//==============================================================================
+int Rater::ratingLevel(int score) {
+    if (score < WEIGHTS[LOCKED_CANDIDATES] * 100) {
+        return 0;
+    }
+    if (score < WEIGHTS[SWORDFISH] * 100) {
+        return 1;
+    }
+    return 2;
+}                         // end of ratingLevel
+//==============================================================================
+
+//====techniqueName=============================================================
+// Description: Names a technique
+// Parameters: technique - Technique
+// Return: readable name
+//==============================================================================
+const char *Rater::techniqueName(int technique) {
+    return TECHNIQUE_NAMES[technique];
+}                         // end of techniqueName
+//==============================================================================
+
+#endif // RATER_H
@@ -0,0 +1,54 @@
+// Rater.h - header file
+
+using namespace std;
+
+// Human solving techniques, easiest first. The rater always uses the
+// easiest one that makes progress
+enum Technique {
+    NAKED_SINGLE,
+    HIDDEN_SINGLE,
+    LOCKED_CANDIDATES,      // pointing and claiming
+    NAKED_PAIR,
+    X_WING,
+    HIDDEN_PAIR,
+    NAKED_TRIPLE,
+    SWORDFISH,
+    HIDDEN_TRIPLE,
+    XY_WING,
+    GUESS,                  // none of the above applies
+    TECHNIQUES
+};
+
+// How hard a puzzle is for a human
+struct Rating {
+    int hardest;                    // hardest Technique needed
+    int score;                      // weight of hardest * 100 + its uses (max 99)
+    int uses[TECHNIQUES];           // times each technique made progress
+};
+
+class Rater {
+private:
+    CandidateGrid grid;
+    int solution[9][9];             // used to make a correct guess when stuck
+    int empty;                      // cells still open
+
+    void place(int cell, int num);
+    bool remove(int cell, unsigned short bits);
+    int nakedSingles();
+    int hiddenSingles();
+    int lockedCandidates();
+    int nakedSubsets(int size);
+    int hiddenSubsets(int size);
+    int fish(int size);
+    int xyWing();
+    int guess();
+    int apply(int technique);
+
+public:
+    static const int WEIGHTS[TECHNIQUES];
+
+    Rater();
+    bool rate(const PackedBoard &board, Rating &rating);
+    static int ratingLevel(int score);
+    static const char *techniqueName(int technique);
+};
@@ -0,0 +1,67 @@
+// Seeds.h - seed puzzles for transform generation
+#ifndef SEEDS_H
+#define SEEDS_H
+
+// Seed puzzles with a unique solution, SEEDS_PER_LEVEL for each difficulty
+// (EASY, MEDIUM, HARD), each followed by its solution. Every random grid
+// symmetry of a seed is a new puzzle with the same number of blanks
+const int SEEDS_PER_LEVEL = 8;
+
+static const char *const SEED_BOARDS[3][SEEDS_PER_LEVEL][2] = {
+    {   // EASY
+        {"68.273591.135...272.5.91..6.59.4276884.659...3261.79547924361..5317286494689153..",
+         "684273591913564827275891436159342768847659213326187954792436185531728649468915372"},
+        {"817439526.657124894295.81739812..3.4.5214.7987..98.2.524.6.78.1.7.8549..59832.6.7",
+         "817439526365712489429568173981275364652143798734986215243697851176854932598321647"},
+        {"4.673..9.129465.388.3.1.456.37146589518.23674694.5721.38.5749.1.61.9.84.94568..27",
+         "456738192129465738873219456237146589518923674694857213382574961761392845945681327"},
+        {"27.9854131.5264879498.37..29.2476.31..78.392434152.786.1.6.8.9586..5214..247.1368",
+         "276985413135264879498137652982476531657813924341529786713648295869352147524791368"},
+        {"293.475.14768.5932...32967438.59.146621784.95.45136.....2961458..42.3719.59.78263",
+         "293647581476815932518329674387592146621784395945136827732961458864253719159478263"},
+        {".27..3.14438219657196.548322138465.99.51..463.649.5281.5.4987268.2367...67..2.348",
+         "527683914438219657196754832213846579985172463764935281351498726842367195679521348"},
+        {".657.42.1842.596.7137.8654959..638726285973.437482.9.5.1.345798..391...645967.12.",
+         "965734281842159637137286549591463872628597314374821965216345798783912456459678123"},
+        {".563281.9413.69827..8.4.635.41956278.274.3.91985.124.316.83.7.28742.53165.2.7.984",
+         "756328149413569827298147635341956278627483591985712463169834752874295316532671984"},
+    },
+    {   // MEDIUM
+        {"73.64.918.127.34.6.9485.2.73.91865.41.82.56932...34...5.13.7..9.8..1.36292..6.17.",
+         "735642918812793456694851237379186524148275693256934781561327849487519362923468175"},
+        {".6..83.91..1.24365345.91..8.7.2.58.4.5..18723...43.95.536879.4.2.9146.374..3.26.9",
+         "762583491891724365345691278973265814654918723128437956536879142289146537417352689"},
+        {"4963871527....26932.59..7..6841.352.3.249..6115962843.8612..9.5.......4..4..6.218",
+         "496387152718542693235916784684173529372495861159628437861234975927851346543769218"},
+        {"12359846.96.74.31..7.6....28.7269153.9.4357283.2.71.....69578.14153.6....8...453.",
+         "123598467968742315574613982847269153691435728352871694236957841415386279789124536"},
+        {"428..1769.6..4.1837..69.45269..75..13.7.19.2.58.4...97.7498.516.3615.9..15..6423.",
+         "428531769965247183713698452692375841347819625581426397274983516836152974159764238"},
+        {"96...34.8.1294.3.6437..12952841..75.3568.794..9..34.8..734.852.6287..1.45.9..2.6.",
+         "965273418812945376437681295284196753356827941791534682173468529628759134549312867"},
+        {"86.327495.936...78.24985......1.8.521852.9743..2.5.68..185.2..93.68...2.2.9436817",
+         "861327495593614278724985136637148952185269743942753681418572369376891524259436817"},
+        {"56782..13....358.7.8..17.2.956..1374.4....1.5138.5429639.168..267..42.388.497.6.1",
+         "567829413219435867483617529956281374742396185138754296395168742671542938824973651"},
+    },
+    {   // HARD
+        {"8...91..461..57.3997...2..552.94.71...1...3987..18.5.2..6.1......5.38.61.476.9..3",
+         "852391674614857239973462185528943716461275398739186542386514927295738461147629853"},
+        {"...1.52...2...6.587..24..1.63751..82241869..559...7.64479.8..2....7.1...3.64.2...",
+         "984135276123976458765248319637514982241869735598327164479683521852791643316452897"},
+        {"9.4.......27.869..5...412.885....4276.1...5.9.49857163.6.5..8......637..3.5278.9.",
+         "984725316127386945536941278853619427671432589249857163762594831498163752315278694"},
+        {".153.6.4..6729..5383.4...21.2.9...6.5.4..3......52..9.98.742..63.26.57..7568.9...",
+         "215386947467291853839457621128974365594163278673528194981742536342615789756839412"},
+        {"5..318...834..6...2..4573.....5..761.486.1...15....84.4.9.62513..51.32.93..9.54..",
+         "597318624834296157261457398923584761748621935156739842479862513685143279312975486"},
+        {"4.6812.3..3..6..1.7215.9.48.973.6.5....1.4.....579.....792.346.81.6.57922.4......",
+         "456812937938467215721539648197326854682154379345798126579283461813645792264971583"},
+        {".84.25...5.7.4681.....9...56725.439.35.28.....41.63..27...32..1.6..7198..1..592..",
+         "984125637527346819136798425672514398359287164841963752798632541265471983413859276"},
+        {"549831..6.7..2....3.256..4181..53769...798..4.....6.82.6.3.48...2..8.4.343..72...",
+         "549831276671429358382567941814253769256798134793146582965314827127685493438972615"},
+    }
+};
+
+#endif // SEEDS_H
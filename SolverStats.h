@@ -0,0 +1,53 @@
+// SolverStats.h - search counters of one solver call, or a sum of many
+#ifndef SOLVERSTATS_H
+#define SOLVERSTATS_H
+
+#include <algorithm>
+using namespace std;
+
+// Build with -DSUDOKU_NO_STATS to compile the counting out of the hot
+// loops; SolverStats stays in the API but every counter reads zero
+#ifdef SUDOKU_NO_STATS
+#define SOLVER_STAT(...)
+#else
+#define SOLVER_STAT(...) __VA_ARGS__
+#endif
+
+struct SolverStats {
+    long long calls;                // top-level calls counted in here
+    long long nodes;                // placements tried
+    long long backtracks;           // placements whose subtree had no solution
+    long long validChecks;          // checkValid calls and candidate lookups
+    int maxDepth;                   // most placements on the stack at once
+    long long maxNodes;             // most placements tried by a single call
+    long long elapsed;              // nanoseconds spent in the calls
+    long long uniqueChecks;         // dug cells tested for a unique solution
+    long long uniqueRejected;       // dug cells put back: solution not unique
+
+    void clear() {
+        calls = 0;
+        nodes = 0;
+        backtracks = 0;
+        validChecks = 0;
+        maxDepth = 0;
+        maxNodes = 0;
+        elapsed = 0;
+        uniqueChecks = 0;
+        uniqueRejected = 0;
+    }
+
+    // Sums another call's counters into these; depth and nodes keep the worst
+    void add(const SolverStats &other) {
+        calls += other.calls;
+        nodes += other.nodes;
+        backtracks += other.backtracks;
+        validChecks += other.validChecks;
+        maxDepth = max(maxDepth, other.maxDepth);
+        maxNodes = max(maxNodes, other.maxNodes);
+        elapsed += other.elapsed;
+        uniqueChecks += other.uniqueChecks;
+        uniqueRejected += other.uniqueRejected;
+    }
+};
+
+#endif // SOLVERSTATS_H
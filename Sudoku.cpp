@@ -2,251 +2,1708 @@
 #ifndef SUDOKU_H
 #define SUDOKU_H
 
+#include "DancingLinks.cpp"
+#include "Propagator.cpp"
+#include "ThreadPool.cpp"
+#include "Random.h"
+#include "SolverStats.h"
+#include "Transform.cpp"
+#include "PuzzleStore.cpp"
+#include "Rater.cpp"
+#include "Seeds.h"
 #include "Sudoku.h"
-#include "Util.h"
 #include <iostream>
-#include <random>
+#include <cstdio>
+#include <chrono>
 #include <algorithm>
 using namespace std;
 
+PackedBoard Sudoku::seedPuzzles[3][SEEDS_PER_LEVEL];
+PackedBoard Sudoku::seedSolutions[3][SEEDS_PER_LEVEL];
+once_flag Sudoku::seedsLoaded;
+
 // Constructor
 Sudoku::Sudoku() {
     this->rows = 9;
     this->cols = 9;
     this->difficulty = EASY;
+    this->searchOrder = ROW_MAJOR;
+    this->backend = BACKTRACKING;
+    this->propagation = false;
+    this->propagationStats = {0, 0, 0, 0, 0, 0};
+    this->cancel = nullptr;
+    this->generationMode = SEARCH;
+    this->store = nullptr;
+    this->minRating = 0;
+    this->maxRating = 0;
+    this->targetClues = 22;
+    this->timeBudget = 100000;
+    this->seed = Random::entropy();
+    rng.reseed(seed);
+    this->triedCells = 0;
+    this->minimalGrid = 0;
+    this->minimalCells = 0;
+    this->replayGrid = -1;
+    this->replayCells = 0;
+    this->nodes = 0;
+    this->stats.clear();
+    this->statsDepth = 0;
+    this->stackDepth = 0;
+    this->searchGoal = FILL_GRID;
+    this->searchCells = ROW_MAJOR;
+    this->searchLimit = 0;
+    this->searchResult = 0;
+    this->searchDone = true;
+    this->generating = false;
+    this->movesCounted = false;
+    clearNotes();
+    board.clear();
+    solvedBoard.clear();
+    buildMasks();
 }
 
-// Destructor
-Sudoku::~Sudoku() {}
+// Destructor
+Sudoku::~Sudoku() {}
+
+//====generateBoard=============================================================
+// Description: Generates a random sudoku board, taking its seed from the
+//              random stream
+//==============================================================================
+bool Sudoku::generateBoard() {
+    return generateBoard(rng.next());
+}                       // end of generateBoard
+//==============================================================================
+
+//====generateBoard=============================================================
+// Description: Generates the sudoku board for a seed. With the same seed,
+//              difficulty and settings it is the same board every time,
+//              except in MINIMAL mode, which stops on the clock
+// Parameters: puzzleSeed - 64-bit seed
+// Return: false if the generation was cancelled, or if no grid could be dug
+//         into the rating band; the board then holds a puzzle rated outside
+//         the band, which must not be passed off as in it
+//==============================================================================
+bool Sudoku::generateBoard(uint64_t puzzleSeed) {
+    this->seed = puzzleSeed;
+    rng.reseed(puzzleSeed);
+
+    SOLVER_STAT(beginStats());
+    bool made = makeBoard();
+    puzzleId = makePuzzleId();
+    movesCounted = false;
+    clearNotes();
+    SOLVER_STAT(endStats());
+
+    return made;
+}                       // end of generateBoard
+//==============================================================================
+
+//====makeBoard=================================================================
+// Description: Makes a new puzzle in the current generation mode from the
+//              random stream, leaving the clues marked as givens
+// Return: false if cancelled, or if MAX_RATING_ATTEMPTS grids all missed
+//         the rating band
+//==============================================================================
+bool Sudoku::makeBoard() {
+    if (generationMode == TRANSFORM) {
+        transformBoard();
+        return true;
+    }
+    if (generationMode == STORE && storeBoard()) {
+        return true;
+    }
+
+    if (generationMode == MINIMAL) {
+        minimalBoard();
+        board.markGivens();
+        return true;
+    }
+
+    const int MAX_RATING_ATTEMPTS = 50;
+    bool made = false;
+
+    for (int attempt = 0; attempt < MAX_RATING_ATTEMPTS && !made; attempt++) {
+        fillGrid();
+        if (cancelled()) {
+            return false;   // the fill was rolled back, nothing to dig
+        }
+
+        // remove the nums
+        if (maxRating == 0) {
+            removeNums();
+            made = true;
+        } else {
+            // with a rating band, dig until the puzzle rates inside it;
+            // grids that never get there are thrown away
+            made = digToRating();
+        }
+    }
+
+    // what's left are the givens
+    board.markGivens();
+    return made;
+}                       // end of makeBoard
+//==============================================================================
+
+//====fillGrid==================================================================
+// Description: Fills an empty board with a random solved grid and keeps it
+//              as the solved board
+//==============================================================================
+void Sudoku::fillGrid() {
+    // Start from an empty board with no givens
+    board.clear();
+
+    // fill the board
+    buildMasks();
+    nodes = 0;
+    SOLVER_STAT(beginStats());
+    startSearch(FILL_GRID, searchOrder, 0, 0);
+    searchSteps();
+    SOLVER_STAT(endStats());
+
+    // keep the solved board
+    solvedBoard = board;
+}                       // end of fillGrid
+//==============================================================================
+
+//====minimalBoard==============================================================
+// Description: Digs fresh grids until no clue can be removed, keeping the
+//              puzzle with the fewest clues, until one reaches the target
+//              clue count or the time budget runs out. A dig cut short by the
+//              deadline still leaves a unique puzzle, just not a minimal one
+//==============================================================================
+void Sudoku::minimalBoard() {
+    if (replayGrid >= 0) {
+        replayMinimal();
+        return;
+    }
+
+    auto deadline = chrono::steady_clock::now() + chrono::microseconds(timeBudget);
+    PackedBoard bestBoard;
+    PackedBoard bestSolved;
+    int bestClues = 82;
+    int grid = 0;
+
+    do {
+        fillGrid();
+        if (cancelled()) {
+            return;
+        }
+        int clues = 81 - digCells(81, deadline);
+
+        // remember how to get back here without the clock, see getPuzzleId
+        if (clues < bestClues) {
+            bestClues = clues;
+            bestBoard = board;
+            bestSolved = solvedBoard;
+            minimalGrid = grid;
+            minimalCells = triedCells;
+        }
+        grid++;
+    } while (bestClues > targetClues && chrono::steady_clock::now() < deadline);
+
+    board = bestBoard;
+    solvedBoard = bestSolved;
+}                       // end of minimalBoard
+//==============================================================================
+
+//====replayMinimal=============================================================
+// Description: Rebuilds a MINIMAL puzzle from its ID. Each grid draws the
+//              same numbers from the random stream as when it was made, so
+//              filling up to the puzzle's grid and digging the same number
+//              of cells gives the same puzzle however long digging takes
+//==============================================================================
+void Sudoku::replayMinimal() {
+    auto never = chrono::steady_clock::time_point::max();
+
+    for (int grid = 0; grid <= replayGrid; grid++) {
+        fillGrid();
+        if (cancelled()) {
+            return;
+        }
+
+        // earlier grids only need their dig order drawn from the stream
+        if (grid < replayGrid) {
+            digCells(0, never);
+        } else {
+            digCells(81, never, replayCells);
+        }
+    }
+
+    minimalGrid = replayGrid;
+    minimalCells = replayCells;
+}                       // end of replayMinimal
+//==============================================================================
+
+//====setSeed===================================================================
+// Description: Restarts the random stream, so the puzzles generateBoard()
+//              makes from here on can be replayed
+// Parameters: streamSeed - 64-bit seed
+//==============================================================================
+void Sudoku::setSeed(uint64_t streamSeed) {
+    rng.reseed(streamSeed);
+}                       // end of setSeed
+//==============================================================================
+
+//====getSeed===================================================================
+// Description: Returns the seed of the last generated puzzle
+// Return: 64-bit seed
+//==============================================================================
+uint64_t Sudoku::getSeed() {
+    return seed;
+}                       // end of getSeed
+//==============================================================================
+
+//====getPuzzleId===============================================================
+// Description: Returns the ID of the last generated puzzle, see makePuzzleId
+// Return: puzzle ID
+//==============================================================================
+string Sudoku::getPuzzleId() {
+    return puzzleId;
+}                       // end of getPuzzleId
+//==============================================================================
+
+//====makePuzzleId==============================================================
+// Description: Names the puzzle just generated as version-level-mode-seed,
+//              e.g. "1-2-s-00c0ffee00c0ffee". The mode part is "s" for
+//              SEARCH ("s300:450" with a rating band), "t" for TRANSFORM,
+//              "d" for STORE and, for MINIMAL, "m" plus the grid the puzzle
+//              came from and the cells tried digging it ("m3.81"), so the
+//              ID doesn't depend on the clock
+// Return: puzzle ID
+//==============================================================================
+string Sudoku::makePuzzleId() {
+    char mode[32];
+    switch (generationMode) {
+        case TRANSFORM:
+            snprintf(mode, sizeof(mode), "t");
+            break;
+        case STORE:
+            snprintf(mode, sizeof(mode), "d");
+            break;
+        case MINIMAL:
+            snprintf(mode, sizeof(mode), "m%d.%d", minimalGrid, minimalCells);
+            break;
+        default:
+            if (maxRating == 0) {
+                snprintf(mode, sizeof(mode), "s");
+            } else {
+                snprintf(mode, sizeof(mode), "s%d:%d", minRating, maxRating);
+            }
+    }
+
+    char id[64];
+    snprintf(id, sizeof(id), "%d-%d-%s-%016llx", GENERATOR_VERSION, difficultyLevel(),
+             mode, (unsigned long long) seed);
+    return id;
+}                       // end of makePuzzleId
+//==============================================================================
+
+//====generateFromId============================================================
+// Description: Takes the difficulty, generation mode and rating band from a
+//              puzzle ID and regenerates the puzzle. A STORE ID needs the
+//              same puzzle store to be set. The solver's own settings and
+//              random stream are put back afterwards, so the next
+//              generateBoard() carries on as if this call hadn't happened
+// Parameters: id - from getPuzzleId
+// Return: false if the ID is malformed, from another generator version, a
+//         STORE ID with no store set, or the puzzle couldn't be generated
+//         (see generateBoard)
+//==============================================================================
+bool Sudoku::generateFromId(const string &id) {
+    int version;
+    int level;
+    char mode[32];
+    unsigned long long puzzleSeed;
+    char extra;
+
+    if (sscanf(id.c_str(), "%d-%d-%31[^-]-%16llx%c", &version, &level, mode, &puzzleSeed,
+               &extra) != 4 || version != GENERATOR_VERSION || level < 0 || level > 2) {
+        return false;
+    }
+
+    int minScore = 0;
+    int maxScore = 0;
+    int grid = -1;
+    int cells = 0;
+
+    int savedMode = generationMode;
+    int savedMin = minRating;
+    int savedMax = maxRating;
+    int savedDifficulty = difficulty;
+    Random savedRng = rng;
+
+    switch (mode[0]) {
+        case 's':
+            if (mode[1] != '\0' && (sscanf(mode + 1, "%d:%d%c", &minScore, &maxScore, &extra) != 2
+                                    || maxScore <= 0)) {
+                return false;
+            }
+            setGenerationMode(SEARCH);
+            setRatingBand(minScore, maxScore);
+            break;
+        case 't':
+            if (mode[1] != '\0') {
+                return false;
+            }
+            setGenerationMode(TRANSFORM);
+            break;
+        case 'd':
+            if (mode[1] != '\0' || store == nullptr) {
+                return false;
+            }
+            setGenerationMode(STORE);
+            break;
+        case 'm':
+            if (sscanf(mode + 1, "%d.%d%c", &grid, &cells, &extra) != 2
+                || grid < 0 || cells < 0 || cells > 81) {
+                return false;
+            }
+            setGenerationMode(MINIMAL);
+            break;
+        default:
+            return false;
+    }
+
+    setDifficulty(level);
+    replayGrid = grid;
+    replayCells = cells;
+    bool made = generateBoard(puzzleSeed);
+    replayGrid = -1;
+
+    generationMode = savedMode;
+    minRating = savedMin;
+    maxRating = savedMax;
+    difficulty = savedDifficulty;
+    rng = savedRng;
+    return made;
+}                       // end of generateFromId
+//==============================================================================
+
+//====loadSeeds=================================================================
+// Description: Parses the seed puzzles and their solutions into the shared
+//              pool. Safe to call from several threads; the work is done once
+//==============================================================================
+void Sudoku::loadSeeds() {
+    call_once(seedsLoaded, [] {
+        for (int level = 0; level < 3; level++) {
+            for (int k = 0; k < SEEDS_PER_LEVEL; k++) {
+                const char *puzzle = SEED_BOARDS[level][k][0];
+                const char *solution = SEED_BOARDS[level][k][1];
+
+                for (int i = 0; i < 81; i++) {
+                    seedPuzzles[level][k].cells[i] = puzzle[i] == '.' ? 0 : puzzle[i] - '0';
+                    seedSolutions[level][k].cells[i] = solution[i] - '0';
+                }
+                seedPuzzles[level][k].markGivens();
+                seedSolutions[level][k].givens[0] = seedPuzzles[level][k].givens[0];
+                seedSolutions[level][k].givens[1] = seedPuzzles[level][k].givens[1];
+            }
+        }
+    });
+}                       // end of loadSeeds
+//==============================================================================
+
+//====difficultyLevel===========================================================
+// Description: Maps the difficulty to a level index
+// Return: 0 for EASY, 1 for MEDIUM, 2 for HARD
+//==============================================================================
+int Sudoku::difficultyLevel() {
+    return difficulty == HARD ? 2 : difficulty == MEDIUM ? 1 : 0;
+}                       // end of difficultyLevel
+//==============================================================================
+
+//====transformBoard============================================================
+// Description: Makes a new puzzle by applying a random grid symmetry to a
+//              seed puzzle of the current difficulty. No search is needed:
+//              the result keeps the seed's unique solution and blank count
+//==============================================================================
+void Sudoku::transformBoard() {
+    loadSeeds();
+
+    int level = difficultyLevel();
+    int k = (int) rng.below(SEEDS_PER_LEVEL);
+
+    Transform transform;
+    transform.randomize(rng);
+    transform.apply(seedPuzzles[level][k], board);
+    transform.apply(seedSolutions[level][k], solvedBoard);
+    nodes = 0;
+}                       // end of transformBoard
+//==============================================================================
+
+//====storeBoard================================================================
+// Description: Takes a random puzzle of the current difficulty from the
+//              puzzle store, along with its solution
+// Return: true if a puzzle was loaded, false if there is no store or it has
+//         nothing at this level
+//==============================================================================
+bool Sudoku::storeBoard() {
+    if (!store) {
+        return false;
+    }
+
+    const PuzzleRecord *record = store->random(difficultyLevel(), rng);
+    if (!record) {
+        return false;
+    }
+
+    unpackRecord(*record, board, solvedBoard);
+    nodes = 0;
+    return true;
+}                       // end of storeBoard
+//==============================================================================
+
+//====digToRating===============================================================
+// Description: Empties cells in random order, keeping each removal that
+//              leaves a unique solution and a rating no higher than the band,
+//              until the rating reaches the band
+// Return: true if the puzzle rates inside the band, false if every cell was
+//         tried first
+//==============================================================================
+bool Sudoku::digToRating() {
+    Rater rater;
+    Rating rating;
+    Propagator solver;
+    int order[81];
+    for (int i = 0; i < 81; i++) {
+        order[i] = i;
+    }
+    rng.shuffle(order, 81);
+
+    buildMasks();
+    for (int i = 0; i < 81; i++) {
+        int x = order[i] / SIZE;
+        int y = order[i] % SIZE;
+        int temp = board.get(x, y);
+        clearNum(x, y);
+
+        if (!uniqueWithout(x, y, temp, solver)) {
+            placeNum(x, y, temp);
+            continue;
+        }
+
+        rater.rate(board, rating);
+        if (rating.score > maxRating) {
+            placeNum(x, y, temp);
+        } else if (rating.score >= minRating) {
+            return true;
+        }
+    }
+
+    return false;
+}                       // end of digToRating
+//==============================================================================
+
+//====fillBoard================================================================
+// Description: Fills the board with random numbers
+// Parameters: x - row, y - column
+// Return: true if the board is filled, false otherwise
+//==============================================================================
+bool Sudoku::fillBoard(int x, int y) {
+    SOLVER_STAT(beginStats());
+    buildMasks();
+    startSearch(FILL_GRID, ROW_MAJOR, x * SIZE + y, 0);
+    searchSteps();
+    SOLVER_STAT(endStats());
+
+    return searchResult > 0;
+}                       // end of fillBoard
+//==============================================================================
+
+//====checkValid===============================================================
+// Description: Checks if a number is valid in a cell
+// Parameters: x - row, y - column, num - number to check
+// Return: true if the number is valid, false otherwise
+//==============================================================================
+bool Sudoku::checkValid(int x, int y, int num) {
+    const int SUBGRID = 3;
+    SOLVER_STAT(stats.validChecks++);
+
+    // check row and column
+    for (int i = 0; i < SIZE; i++) {
+        if (board.get(x, i) == num || board.get(i, y) == num) {
+            return false;
+        }
+    }
+
+    // check sub-grid (3x3)
+    int startRow = x - x % SUBGRID;
+    int startCol = y - y % SUBGRID;
+    for (int r = startRow; r < startRow + SUBGRID; r++) {
+        for (int c = startCol; c < startCol + SUBGRID; c++) {
+            if (board.get(r, c) == num) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}                         // end of checkValid
+//==============================================================================
+
+//====boxIndex=================================================================
+// Description: Returns the index (0-8) of the 3x3 box containing a cell
+// Parameters: x - row, y - column
+// Return: box index, numbered row-major
+//==============================================================================
+int Sudoku::boxIndex(int x, int y) {
+    return (x / 3) * 3 + y / 3;
+}                         // end of boxIndex
+//==============================================================================
+
+//====buildMasks===============================================================
+// Description: Rebuilds the row, column and box masks from the board
+// Return: false if two numbers clash in a row, column or box; the masks
+//         can't show the repeat, so a search from there never runs dry
+//==============================================================================
+bool Sudoku::buildMasks() {
+    bool clash = false;
+    movesCounted = false;
+
+    for (int i = 0; i < SIZE; i++) {
+        rowMask[i] = 0;
+        colMask[i] = 0;
+        boxMask[i] = 0;
+    }
+
+    for (int i = 0; i < SIZE; i++) {
+        for (int j = 0; j < SIZE; j++) {
+            if (board.get(i, j) != 0) {
+                unsigned short bit = 1 << (board.get(i, j) - 1);
+                if ((rowMask[i] | colMask[j] | boxMask[boxIndex(i, j)]) & bit) {
+                    clash = true;
+                }
+                rowMask[i] |= bit;
+                colMask[j] |= bit;
+                boxMask[boxIndex(i, j)] |= bit;
+            }
+        }
+    }
+
+    return !clash;
+}                         // end of buildMasks
+//==============================================================================
+
+//====placeNum=================================================================
+// Description: Writes a number to an empty cell and marks it in the masks
+// Parameters: x - row, y - column, num - number to place
+//==============================================================================
+void Sudoku::placeNum(int x, int y, int num) {
+    unsigned short bit = 1 << (num - 1);
+    board.set(x, y, num);
+    rowMask[x] |= bit;
+    colMask[y] |= bit;
+    boxMask[boxIndex(x, y)] |= bit;
+}                         // end of placeNum
+//==============================================================================
+
+//====clearNum=================================================================
+// Description: Empties a cell and unmarks its number in the masks
+// Parameters: x - row, y - column
+//==============================================================================
+void Sudoku::clearNum(int x, int y) {
+    unsigned short bit = ~(1 << (board.get(x, y) - 1));
+    board.set(x, y, 0);
+    rowMask[x] &= bit;
+    colMask[y] &= bit;
+    boxMask[boxIndex(x, y)] &= bit;
+}                         // end of clearNum
+//==============================================================================
+
+//====countMoves===============================================================
+// Description: Recounts every number on the board for the conflict queries.
+//              Only runs after a search or a load has changed the board;
+//              setBoard keeps the counts current between them
+//==============================================================================
+void Sudoku::countMoves() const {
+    memset(rowCount, 0, sizeof(rowCount));
+    memset(colCount, 0, sizeof(colCount));
+    memset(boxCount, 0, sizeof(boxCount));
+    memset(rowHas, 0, sizeof(rowHas));
+    memset(colHas, 0, sizeof(colHas));
+    memset(boxHas, 0, sizeof(boxHas));
+    filledCells = 0;
+    clashes = 0;
+
+    for (int i = 0; i < SIZE; i++) {
+        for (int j = 0; j < SIZE; j++) {
+            if (board.get(i, j) != 0) {
+                tallyMove(i, j, board.get(i, j), 1);
+            }
+        }
+    }
+
+    movesCounted = true;
+}                         // end of countMoves
+//==============================================================================
+
+//====tallyMove================================================================
+// Description: Adds or takes away one copy of a number in its row, column
+//              and box counts, tracking units that go to or from a clash
+//              and units that gain or lose the number altogether
+// Parameters: x - row, y - column, num - 1-9, change - 1 or -1
+//==============================================================================
+void Sudoku::tallyMove(int x, int y, int num, int change) const {
+    int box = (x / 3) * 3 + y / 3;
+    unsigned short bit = 1 << (num - 1);
+    unsigned char *counts[3] = {
+        &rowCount[x][num - 1],
+        &colCount[y][num - 1],
+        &boxCount[box][num - 1]
+    };
+    unsigned short *has[3] = {&rowHas[x], &colHas[y], &boxHas[box]};
+
+    filledCells += change;
+    for (int i = 0; i < 3; i++) {
+        if (change < 0 && *counts[i] == 2) {
+            clashes--;
+        }
+        *counts[i] += change;
+        if (change > 0 && *counts[i] == 2) {
+            clashes++;
+        }
+
+        if (*counts[i] == 0) {
+            *has[i] &= ~bit;
+        } else {
+            *has[i] |= bit;
+        }
+    }
+}                         // end of tallyMove
+//==============================================================================
+
+//====candidates===============================================================
+// Description: Returns the numbers that can legally go in a cell
+// Parameters: x - row, y - column
+// Return: 9-bit mask, bit (num - 1) set if num is a candidate
+//==============================================================================
+unsigned short Sudoku::candidates(int x, int y) {
+    SOLVER_STAT(stats.validChecks++);
+    return ~(rowMask[x] | colMask[y] | boxMask[boxIndex(x, y)]) & 0x1FF;
+}                         // end of candidates
+//==============================================================================
+
+//====randomNum================================================================
+// Description: Fills an array with numbers 1-9 and shuffles them
+// Parameters: arr - array to fill
+//==============================================================================
+void Sudoku::randomNum(int arr[]) {
+    // fill array with numbers 1-9
+    for (int i = 0; i < SIZE; i++) {
+        arr[i] = i + 1;
+    }
+
+    // shuffle array
+    rng.shuffle(arr, SIZE);
+}                        // end of randomNum
+//==============================================================================
+
+//====setDifficulty============================================================
+// Description: Sets the difficulty level
+// Parameters: num - difficulty level
+//==============================================================================
+void Sudoku::setDifficulty(int num) {
+    switch (num) {
+        case 0:
+            this->difficulty = EASY;
+            break;
+        case 1:
+            this->difficulty = MEDIUM;
+            break;
+        case 2:
+            this->difficulty = HARD;
+            break;
+        default:
+            cout << "Invalid difficult level" << endl;
+    }
+}                    // end of setDifficulty
+//==============================================================================
+
+//====setSearchOrder===========================================================
+// Description: Sets how the solver picks the next cell to branch on
+// Parameters: order - ROW_MAJOR or MOST_CONSTRAINED
+//==============================================================================
+void Sudoku::setSearchOrder(int order) {
+    switch (order) {
+        case ROW_MAJOR:
+        case MOST_CONSTRAINED:
+            this->searchOrder = order;
+            break;
+        default:
+            cout << "Invalid search order" << endl;
+    }
+}                    // end of setSearchOrder
+//==============================================================================
+
+//====setBackend===============================================================
+// Description: Sets the engine used to solve and count solutions
+// Parameters: engine - BACKTRACKING or DANCING_LINKS
+//==============================================================================
+void Sudoku::setBackend(int engine) {
+    switch (engine) {
+        case BACKTRACKING:
+        case DANCING_LINKS:
+            this->backend = engine;
+            break;
+        default:
+            cout << "Invalid backend" << endl;
+    }
+}                    // end of setBackend
+//==============================================================================
+
+//====setGenerationMode=======================================================
+// Description: Sets how generateBoard makes new puzzles
+// Parameters: mode - SEARCH, TRANSFORM, STORE or MINIMAL
+//==============================================================================
+void Sudoku::setGenerationMode(int mode) {
+    switch (mode) {
+        case SEARCH:
+        case TRANSFORM:
+        case STORE:
+        case MINIMAL:
+            this->generationMode = mode;
+            break;
+        default:
+            cout << "Invalid generation mode" << endl;
+    }
+}                    // end of setGenerationMode
+//==============================================================================
+
+//====setPuzzleStore============================================================
+// Description: Sets the store STORE mode draws from. Levels the store has no
+//              puzzles for fall back to SEARCH
+// Parameters: puzzles - open store, or nullptr; must outlive its use here
+//==============================================================================
+void Sudoku::setPuzzleStore(const PuzzleStore *puzzles) {
+    this->store = puzzles;
+}                    // end of setPuzzleStore
+//==============================================================================
+
+//====setRatingBand============================================================
+// Description: Makes SEARCH mode dig until the puzzle's human-technique
+//              rating (see Rater) is inside a band, instead of removing a
+//              fixed number of cells. generateBoard returns false when no
+//              grid reaches the band
+// Parameters: minScore - lowest score accepted, maxScore - highest score
+//             accepted, 0 to go back to the difficulty's cell count
+//==============================================================================
+void Sudoku::setRatingBand(int minScore, int maxScore) {
+    this->minRating = minScore;
+    this->maxRating = maxScore;
+}                    // end of setRatingBand
+//==============================================================================
+
+//====setMinimalGoal============================================================
+// Description: Sets what MINIMAL mode aims for and how long it may take
+// Parameters: clues - stop once a minimal puzzle has this many clues or
+//             fewer, budget - wall-clock limit per puzzle in microseconds
+//==============================================================================
+void Sudoku::setMinimalGoal(int clues, long long budget) {
+    this->targetClues = clues;
+    this->timeBudget = budget;
+}                    // end of setMinimalGoal
+//==============================================================================
+
+//====setPropagation===========================================================
+// Description: Turns the singles/locked candidates propagation on or off for
+//              the backtracking backend
+// Parameters: enabled - true to propagate before and after every guess
+//==============================================================================
+void Sudoku::setPropagation(bool enabled) {
+    this->propagation = enabled;
+}                    // end of setPropagation
+//==============================================================================
+
+//====getPropagationStats======================================================
+// Description: Returns how much each propagation rule resolved in the last
+//              count or solve
+// Return: propagation counters
+//==============================================================================
+PropagationStats Sudoku::getPropagationStats() {
+    return propagationStats;
+}                    // end of getPropagationStats
+//==============================================================================
+
+//====solveBoard===============================================================
+// Description: Fills in the board with its first solution
+// Return: true if the board was solved, false if it has no solution
+//==============================================================================
+bool Sudoku::solveBoard() {
+    bool solved;
+    SOLVER_STAT(beginStats());
+
+    if (backend == DANCING_LINKS) {
+        DancingLinks dlx;
+        dlx.setCancelFlag(cancel);
+        solved = dlx.solve(board);
+        nodes = dlx.getNodeCount();
+        SOLVER_STAT(stats.nodes += nodes;
+                    stats.backtracks += dlx.getBacktrackCount();
+                    stats.maxDepth = max(stats.maxDepth, dlx.getMaxDepth()));
+    } else if (propagation) {
+        Propagator solver;
+        solver.setCancelFlag(cancel);
+        solved = solver.solve(board);
+        propagationStats = solver.getStats();
+        nodes = propagationStats.guesses;
+        SOLVER_STAT(stats.nodes += nodes;
+                    stats.backtracks += propagationStats.backtracks;
+                    stats.maxDepth = max(stats.maxDepth, propagationStats.maxDepth));
+    } else if (!buildMasks()) {
+        // clashing givens, as the other backends reject them
+        nodes = 0;
+        solved = false;
+    } else {
+        // the search stops with the solution still on the board
+        nodes = 0;
+        startSearch(FIND_SOLUTION, searchOrder, 0, 1);
+        searchSteps();
+        solved = searchResult > 0;
+    }
+
+    movesCounted = false;
+    SOLVER_STAT(endStats());
+    return solved;
+}                    // end of solveBoard
+//==============================================================================
+
+//====setCancelFlag============================================================
+// Description: Sets a flag that makes a running count or solve give up
+// Parameters: flag - cancel flag, or nullptr to never stop early
+//==============================================================================
+void Sudoku::setCancelFlag(const atomic<bool> *flag) {
+    this->cancel = flag;
+}                    // end of setCancelFlag
+//==============================================================================
+
+//====cancelled================================================================
+// Description: Checks the cancel flag
+// Return: true if the current search should stop
+//==============================================================================
+bool Sudoku::cancelled() {
+    return cancel && cancel->load(memory_order_relaxed);
+}                    // end of cancelled
+//==============================================================================
+
+//====splitBoard===============================================================
+// Description: Expands the first branching levels of the search tree and
+//              collects the boards left at the bottom. Forced cells are
+//              filled without using up a level and dead ends are dropped
+// Parameters: levels - branching levels still to expand,
+//             frontier - receives one board snapshot per subtree
+//==============================================================================
+void Sudoku::splitBoard(int levels, vector<PackedBoard> &frontier) {
+    int x, y;
+    unsigned short open;
+
+    int cell = mostConstrained(x, y, open);
+    if (cell < 0) {
+        return;
+    }
+    if (cell == 0 || levels == 0) {
+        frontier.push_back(snapshot());
+        return;
+    }
+
+    bool forced = (open & (open - 1)) == 0;
+    while (open) {
+        int num = __builtin_ctz(open) + 1;
+        open &= open - 1;
+
+        placeNum(x, y, num);
+        splitBoard(forced ? levels : levels - 1, frontier);
+        clearNum(x, y);
+    }
+}                    // end of splitBoard
+//==============================================================================
+
+//====splitSearch==============================================================
+// Description: Splits the board into independent subtrees, adding levels
+//              until there are enough to keep every worker busy
+// Parameters: parts - number of subtrees wanted
+// Return: subtree boards; together they hold every solution exactly once
+//==============================================================================
+vector<PackedBoard> Sudoku::splitSearch(int parts) {
+    const int MAX_LEVELS = 6;
+    vector<PackedBoard> frontier;
+
+    buildMasks();
+    for (int levels = 1; levels <= MAX_LEVELS; levels++) {
+        frontier.clear();
+        splitBoard(levels, frontier);
+
+        if ((int) frontier.size() >= parts) {
+            break;
+        }
+    }
+
+    return frontier;
+}                    // end of splitSearch
+//==============================================================================
+
+//====countSolutionsParallel===================================================
+// Description: Counts solutions by splitting the search tree and counting
+//              the subtrees on a thread pool. With a limit, the remaining
+//              subtrees are cancelled as soon as the total reaches it
+// Parameters: pool - worker threads, limit - stop once this many are found
+//             (0 counts them all)
+// Return: number of solutions, at most limit when limit > 0; 0 if the
+//         givens clash
+//==============================================================================
+int Sudoku::countSolutionsParallel(ThreadPool &pool, int limit) {
+    // clashing givens would leave every subtree searching without end
+    if (hasConflicts()) {
+        nodes = 0;
+        SOLVER_STAT(stats.clear());
+        return 0;
+    }
+
+    SOLVER_STAT(beginStats());
+    vector<PackedBoard> frontier = splitSearch(pool.size() * 8);
+    vector<Sudoku> solvers(pool.size(), *this);
+    vector<SolverStats> parts(pool.size());
+    vector<long long> partNodes(pool.size(), 0);
+    atomic<bool> stop(false);
+    atomic<int> total(0);
+
+    for (Sudoku &solver : solvers) {
+        solver.setCancelFlag(&stop);
+    }
+
+    for (const PackedBoard &part : frontier) {
+        pool.submit([&solvers, &parts, &partNodes, &stop, &total, &part, limit](int id) {
+            if (stop.load(memory_order_relaxed)) {
+                return;
+            }
+
+            Sudoku &solver = solvers[id];
+            solver.restore(part);
+            int found = solver.countSolutions(limit);
+            partNodes[id] += solver.nodes;
+            SOLVER_STAT(parts[id].add(solver.stats));
+
+            if (limit && total.fetch_add(found) + found >= limit) {
+                stop.store(true);
+            } else if (!limit) {
+                total.fetch_add(found);
+            }
+        });
+    }
+    pool.wait();
+
+    nodes = 0;
+    for (long long count : partNodes) {
+        nodes += count;
+    }
+    for (size_t i = 0; i < parts.size(); i++) {
+        SOLVER_STAT(stats.add(parts[i]));
+    }
+    SOLVER_STAT(endStats());
+
+    int solutions = total.load();
+    return (limit && solutions > limit) ? limit : solutions;
+}                    // end of countSolutionsParallel
+//==============================================================================
+
+//====solveBoardParallel=======================================================
+// Description: Solves the board by searching its subtrees on a thread pool;
+//              the first subtree to find a solution cancels the others
+// Parameters: pool - worker threads
+// Return: true if the board was solved, false if it has no solution or
+//         its givens clash
+//==============================================================================
+bool Sudoku::solveBoardParallel(ThreadPool &pool) {
+    if (hasConflicts()) {
+        nodes = 0;
+        SOLVER_STAT(stats.clear());
+        return false;
+    }
+
+    // one worker would search the subtrees back to back, which costs more
+    // than the plain search in the same cell order
+    if (pool.size() == 1) {
+        int order = searchOrder;
+        searchOrder = MOST_CONSTRAINED;
+        bool solved = solveBoard();
+        searchOrder = order;
+        return solved;
+    }
+
+    SOLVER_STAT(beginStats());
+    vector<PackedBoard> frontier = splitSearch(pool.size() * 8);
+    vector<Sudoku> solvers(pool.size(), *this);
+    vector<SolverStats> parts(pool.size());
+    vector<long long> partNodes(pool.size(), 0);
+    atomic<bool> stop(false);
+    mutex resultLock;
+    bool solved = false;
+    PackedBoard result;
+
+    // most subtrees hold no solution and are searched to the end, which
+    // the most constrained cell order does far faster than row order
+    for (Sudoku &solver : solvers) {
+        solver.setCancelFlag(&stop);
+        solver.setSearchOrder(MOST_CONSTRAINED);
+    }
+
+    for (const PackedBoard &part : frontier) {
+        pool.submit([&solvers, &parts, &partNodes, &stop, &resultLock, &solved, &result,
+                     &part](int id) {
+            if (stop.load(memory_order_relaxed)) {
+                return;
+            }
+
+            Sudoku &solver = solvers[id];
+            solver.restore(part);
+            bool partSolved = solver.solveBoard();
+            partNodes[id] += solver.nodes;
+            SOLVER_STAT(parts[id].add(solver.stats));
+            if (partSolved) {
+                lock_guard<mutex> guard(resultLock);
+                if (!solved) {
+                    result = solver.snapshot();
+                    solved = true;
+                    stop.store(true);
+                }
+            }
+        });
+    }
+    pool.wait();
+
+    // every subtree a worker searched, not just its last one
+    nodes = 0;
+    for (long long count : partNodes) {
+        nodes += count;
+    }
+    for (size_t i = 0; i < parts.size(); i++) {
+        SOLVER_STAT(stats.add(parts[i]));
+    }
+    SOLVER_STAT(endStats());
+
+    if (!solved) {
+        return false;
+    }
+
+    // keep this board's givens, the subtree copy has none of its own
+    for (int i = 0; i < 81; i++) {
+        board.cells[i] = result.cells[i];
+    }
+    movesCounted = false;
+
+    return true;
+}                    // end of solveBoardParallel
+//==============================================================================
+
+//====getNodeCount=============================================================
+// Description: Returns the search tree size of the last fill or count
+// Return: number of placements tried
+//==============================================================================
+long long Sudoku::getNodeCount() {
+    return nodes;
+}                    // end of getNodeCount
+//==============================================================================
+
+//====getSolverStats===========================================================
+// Description: Returns the counters of the last fillBoard, solutionCounter,
+//              countSolutions, solveBoard, removeNums or generateBoard call,
+//              including the searches it made. All zero when built with
+//              SUDOKU_NO_STATS
+// Return: search counters, calls is 1
+//==============================================================================
+SolverStats Sudoku::getSolverStats() {
+    return stats;
+}                    // end of getSolverStats
+//==============================================================================
+
+//====beginStats===============================================================
+// Description: Opens a public call; the outermost one clears the counters
+//              and starts the clock
+//==============================================================================
+void Sudoku::beginStats() {
+    if (statsDepth++ == 0) {
+        stats.clear();
+        statsStart = chrono::steady_clock::now();
+    }
+}                    // end of beginStats
+//==============================================================================
+
+//====endStats=================================================================
+// Description: Closes a public call; the outermost one stops the clock
+//==============================================================================
+void Sudoku::endStats() {
+    if (--statsDepth == 0) {
+        stats.calls = 1;
+        stats.maxNodes = stats.nodes;
+        stats.elapsed = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - statsStart).count();
+    }
+}                    // end of endStats
+//==============================================================================
+
+//====checkSolution============================================================
+// Description: Checks if the puzzle has a unique solution
+// Return: true if the puzzle has a unique solution, false otherwise
+//==============================================================================
+bool Sudoku::checkSolution() {
+    // a second solution is enough to reject, so stop counting there
+    int solutions = countSolutions(2);
+
+    if (solutions != 1) {
+        return false;
+    }
+
+    return true;
+}                    // end of checkSolution
+//==============================================================================
+
+//====countSolutions===========================================================
+// Description: Counts the solutions of the current board, stopping early
+// Parameters: limit - stop once this many are found (0 counts them all)
+// Return: number of solutions, at most limit when limit > 0
+//==============================================================================
+int Sudoku::countSolutions(int limit) {
+    int solutions;
+    SOLVER_STAT(beginStats());
+
+    if (backend == DANCING_LINKS) {
+        DancingLinks dlx;
+        dlx.setCancelFlag(cancel);
+        dlx.load(board);
+        solutions = dlx.count(limit);
+        nodes = dlx.getNodeCount();
+        SOLVER_STAT(stats.nodes += nodes;
+                    stats.backtracks += dlx.getBacktrackCount();
+                    stats.maxDepth = max(stats.maxDepth, dlx.getMaxDepth()));
+    } else if (propagation) {
+        Propagator solver;
+        solver.setCancelFlag(cancel);
+        solutions = solver.load(board) ? solver.count(limit) : 0;
+        propagationStats = solver.getStats();
+        nodes = propagationStats.guesses;
+        SOLVER_STAT(stats.nodes += nodes;
+                    stats.backtracks += propagationStats.backtracks;
+                    stats.maxDepth = max(stats.maxDepth, propagationStats.maxDepth));
+    } else if (!buildMasks()) {
+        nodes = 0;
+        solutions = 0;
+    } else {
+        nodes = 0;
+        startSearch(COUNT_SOLUTIONS, searchOrder, 0, limit);
+        searchSteps();
+        solutions = searchResult;
+    }
+
+    SOLVER_STAT(endStats());
+    return solutions;
+}                   // end of countSolutions
+//==============================================================================
+
+//====solutionCounter==========================================================
+// Description: Counts the number of solutions for the puzzle
+// Parameters: x - row, y - column, limit - stop once this many are found
+//             (0 counts them all)
+// Return: number of solutions
+//==============================================================================
+int Sudoku::solutionCounter(int x, int y, int limit) {
+    SOLVER_STAT(beginStats());
+    buildMasks();
+    startSearch(COUNT_SOLUTIONS, ROW_MAJOR, x * SIZE + y, limit);
+    searchSteps();
+    SOLVER_STAT(endStats());
 
-//====generateBoard=============================================================
-// Description: Generates a random sudoku board
+    return searchResult;
+}                        // end of solutionCounter
 //==============================================================================
-void Sudoku::generateBoard() {
-    // Initialize the board with zeros or any other default value
-    for (int i = 0; i < SIZE; ++i) {
-        for (int j = 0; j < SIZE; ++j) {
-            board[i][j] = 0;
-        }
-    }
 
-    // fill the board
-    fillBoard(0, 0);
+//====mostConstrained==========================================================
+// Description: Finds the empty cell with the fewest candidates
+// Parameters: x - row found, y - column found, open - its candidates
+// Return: 1 if a cell was found, 0 if the board is full, -1 if some empty
+//         cell has no candidates left
+//==============================================================================
+int Sudoku::mostConstrained(int &x, int &y, unsigned short &open) {
+    int best = SIZE + 1;
 
-    // copy the solved board
     for (int i = 0; i < SIZE; i++) {
         for (int j = 0; j < SIZE; j++) {
-            solvedBoard[i][j] = board[i][j];
+            if (board.get(i, j) != 0) {
+                continue;
+            }
+
+            unsigned short cell = candidates(i, j);
+            int count = __builtin_popcount(cell);
+
+            // dead end: no need to look any further
+            if (count == 0) {
+                return -1;
+            }
+
+            if (count < best) {
+                best = count;
+                x = i;
+                y = j;
+                open = cell;
+
+                // a forced cell can't be beaten
+                if (count == 1) {
+                    return 1;
+                }
+            }
         }
     }
 
-    // remove the nums
-    removeNums();
+    return best <= SIZE ? 1 : 0;
+}                      // end of mostConstrained
+//==============================================================================
 
-    // copy the unsolved board
-    for (int i = 0; i < SIZE; i++) {
-        for (int j = 0; j < SIZE; j++) {
-            unsolvedBoard[i][j] = board[i][j];
+//====startSearch==============================================================
+// Description: Sets up the iterative search on the current board without
+//              running it; searchSteps does the work. Expects the masks to
+//              match the board
+// Parameters: goal - SearchGoal, order - SearchOrder to pick cells in,
+//             start - first cell (x * 9 + y) for ROW_MAJOR, limit -
+//             COUNT_SOLUTIONS: stop once this many are found (0 counts them
+//             all)
+//==============================================================================
+void Sudoku::startSearch(int goal, int order, int start, int limit) {
+    movesCounted = false;
+    searchGoal = goal;
+    searchCells = order;
+    searchLimit = limit;
+    searchResult = 0;
+    searchDone = false;
+    stackDepth = 0;
+
+    // row-major visits the empty cells in order, so list them once
+    emptyCount = 0;
+    for (int i = start; i < 81; i++) {
+        if (board.cells[i] == 0) {
+            emptyCells[emptyCount++] = i;
         }
     }
-}                       // end of generateBoard
+
+    int depth = descend(0, 0);
+    if (depth >= 0) {
+        stackDepth = depth;
+    }
+}                      // end of startSearch
 //==============================================================================
 
-//====fillBoard================================================================
-// Description: Fills the board with random numbers
-// Parameters: x - row, y - column
-// Return: true if the board is filled, false otherwise
+//====descend==================================================================
+// Description: Picks the next cell to branch on and pushes a frame with its
+//              candidates. A full board counts as a solution; a cell with
+//              no candidates pushes nothing, so the frame below moves on
+// Parameters: next - ROW_MAJOR: position in emptyCells of the next cell,
+//             depth - frames in use, kept by the caller while it runs
+// Return: frames in use afterwards, or -1 if the search ended here
 //==============================================================================
-bool Sudoku::fillBoard(int x, int y) {
-    // base case: if the puzzle is filled
-    if (x == SIZE) {
-        return true;
+int Sudoku::descend(int next, int depth) {
+    int x, y;
+    unsigned short open;
+    int cell;
+
+    // another thread already has the answer
+    if (cancelled()) {
+        stackDepth = depth;
+        finishSearch(false);
+        return -1;
+    }
+
+    if (searchCells == MOST_CONSTRAINED) {
+        cell = mostConstrained(x, y, open);
+    } else {
+        cell = next < emptyCount ? 1 : 0;
+        if (cell) {
+            x = emptyCells[next] / 9;
+            y = emptyCells[next] % 9;
+            open = candidates(x, y);
+
+            // dead end; a fill still shuffles for it, as fillBoard always has
+            if (open == 0) {
+                if (searchGoal == FILL_GRID) {
+                    randomNum(searchStack[depth].order);
+                }
+                return depth;
+            }
+        }
     }
 
-    // iterates through each cell
-    int nextRow = (y == SIZE - 1) ? x + 1 : x;
-    int nextCol = (y + 1) % SIZE;
+    if (cell < 0) {
+        return depth;
+    }
+
+    // full board: a fill or a solve stops on it, a count keeps going
+    if (cell == 0) {
+        searchResult++;
+        if (searchGoal != COUNT_SOLUTIONS || (searchLimit && searchResult >= searchLimit)) {
+            stackDepth = depth;
+            finishSearch(searchGoal != COUNT_SOLUTIONS);
+            return -1;
+        }
+        return depth;
+    }
+
+    SearchFrame &frame = searchStack[depth];
+    frame.index = next;
+    frame.x = x;
+    frame.y = y;
+    frame.placed = false;
+    frame.open = open;
 
     // shuffle through numbers
-    int numbers[SIZE] = {0};
-    randomNum(numbers);
+    if (searchGoal == FILL_GRID) {
+        randomNum(frame.order);
+        frame.next = 0;
+    }
 
-    for (int num : numbers) {
-        // check if number is valid 
-        if (checkValid(x, y, num)) {
-            board[x][y] = num;
+    return depth + 1;
+}                      // end of descend
+//==============================================================================
 
-            // recursive call: move to next cell
-            if (fillBoard(nextRow, nextCol)) {
-                return true;
+//====finishSearch=============================================================
+// Description: Ends the search, emptying the stack
+// Parameters: keep - leave the placed numbers on the board; otherwise the
+//             board goes back to how it was when the search started
+//==============================================================================
+void Sudoku::finishSearch(bool keep) {
+    if (!keep) {
+        for (int i = 0; i < stackDepth; i++) {
+            if (searchStack[i].placed) {
+                clearNum(searchStack[i].x, searchStack[i].y);
             }
-
-            // backtrack
-            board[x][y] = 0;
         }
     }
 
-    // no valid number found for this cell
-    return false;
-}                       // end of fillBoard
+    stackDepth = 0;
+    searchDone = true;
+}                      // end of finishSearch
 //==============================================================================
 
-//====checkValid===============================================================
-// Description: Checks if a number is valid in a cell
-// Parameters: x - row, y - column, num - number to check
-// Return: true if the number is valid, false otherwise
+//====searchSteps==============================================================
+// Description: Runs the search set up by startSearch until it ends or the
+//              budget runs out. Stopping leaves the stack as it is, so the
+//              next call carries on with the same placement it would have
+//              made; a search cut into slices visits the same nodes in the
+//              same order as one run straight through
+// Parameters: steps - placements to make at most, deadline - stop once this
+//             time has passed (checked every few dozen placements)
+// Return: true once the search has ended, false if it stopped on budget
 //==============================================================================
-bool Sudoku::checkValid(int x, int y, int num) {
-    const int SUBGRID = 3;
+bool Sudoku::searchSteps(long long steps, chrono::steady_clock::time_point deadline) {
+    const int CLOCK_EVERY = 64;     // placements between deadline checks
+    bool timed = deadline != chrono::steady_clock::time_point::max();
+    bool fill = searchGoal == FILL_GRID;
+    int depth = stackDepth;         // in locals: board writes can alias members
+    long long taken = 0;
 
-    // check row and column
-    for (int i = 0; i < SIZE; i++) {
-        if (board[x][i] == num || board[i][y] == num) {
-            return false;
-        }
+    if (searchDone) {
+        return true;
     }
 
-    // check sub-grid (3x3)
-    int startRow = x - x % SUBGRID;
-    int startCol = y - y % SUBGRID;
-    for (int r = startRow; r < startRow + SUBGRID; r++) {
-        for (int c = startCol; c < startCol + SUBGRID; c++) {
-            if (board[r][c] == num) {
+    while (depth > 0) {
+        // the top frame's state stays in registers until it is left
+        SearchFrame &frame = searchStack[depth - 1];
+        int x = frame.x;
+        int y = frame.y;
+        unsigned short open = frame.open;
+        bool placed = frame.placed;
+
+        while (true) {
+            // backtrack: take the last number back off the board
+            if (placed) {
+                clearNum(x, y);
+                placed = false;
+                frame.placed = false;
+                SOLVER_STAT(if (searchGoal != COUNT_SOLUTIONS || searchResult == frame.before) {
+                    stats.backtracks++;
+                });
+            }
+
+            // every number tried: the frame below moves on
+            if (open == 0) {
+                depth--;
+                break;
+            }
+
+            // out of budget, resume from this placement
+            if (taken == steps || (timed && taken > 0 && taken % CLOCK_EVERY == 0 &&
+                                   chrono::steady_clock::now() >= deadline)) {
+                frame.open = open;
+                stackDepth = depth;
                 return false;
             }
+
+            // next candidate in shuffled order for a fill, else lowest first
+            int num;
+            if (fill) {
+                do {
+                    num = frame.order[frame.next++];
+                } while (!(open & (1 << (num - 1))));
+            } else {
+                num = __builtin_ctz(open) + 1;
+            }
+            open &= ~(1 << (num - 1));
+
+            placeNum(x, y, num);
+            placed = true;
+            frame.placed = true;
+            SOLVER_STAT(frame.before = searchResult);
+            taken++;
+            nodes++;
+            SOLVER_STAT(stats.nodes++;
+                        stats.maxDepth = max(stats.maxDepth, depth));
+
+            int next = descend(frame.index + 1, depth);
+            if (next < 0) {
+                return true;
+            }
+
+            // a frame was pushed: carry on from it
+            if (next > depth) {
+                frame.open = open;
+                depth = next;
+                break;
+            }
         }
     }
 
+    stackDepth = 0;
+    finishSearch(true);
     return true;
-}                         // end of checkValid
+}                      // end of searchSteps
 //==============================================================================
 
-//====randomNum================================================================
-// Description: Fills an array with numbers 1-9 and shuffles them
-// Parameters: arr - array to fill
+//====startGenerate============================================================
+// Description: Starts generating a puzzle in slices: the random fill runs in
+//              runSearch calls and the holes are dug in the call that
+//              finishes it. Gives the same puzzle for a seed as
+//              generateBoard(); other generation modes and rating bands
+//              generate the whole board here instead, and a missed band
+//              leaves the result 0
 //==============================================================================
-void Sudoku::randomNum(int arr[]) {
-    // fill array with numbers 1-9
-    for (int i = 0; i < SIZE; i++) {
-        arr[i] = i + 1;
+void Sudoku::startGenerate() {
+    if (generationMode != SEARCH || maxRating != 0) {
+        searchResult = generateBoard() ? 1 : 0;
+        searchDone = true;
+        return;
     }
 
-    // shuffle array 
-    random_device rd;
-    mt19937 gen(rd());  // Mersenne Twister engine
-    shuffle(arr, arr + SIZE, gen);
-}                        // end of randomNum
+    seed = rng.next();
+    rng.reseed(seed);
+    puzzleId = makePuzzleId();
+
+    board.clear();
+    buildMasks();
+    clearNotes();
+    nodes = 0;
+    SOLVER_STAT(stats.clear());
+    generating = true;
+    startSearch(FILL_GRID, searchOrder, 0, 0);
+}                      // end of startGenerate
 //==============================================================================
 
-//====setDifficulty============================================================
-// Description: Sets the difficulty level
-// Parameters: num - difficulty level
+//====startFill================================================================
+// Description: Starts filling the empty cells with random numbers in slices,
+//              see runSearch
 //==============================================================================
-void Sudoku::setDifficulty(int num) {
-    switch (num) {
-        case 0:
-            this->difficulty = EASY;
-            break;
-        case 1:
-            this->difficulty = MEDIUM;
-            break;
-        case 2:
-            this->difficulty = HARD;
-            break;
-        default:
-            cout << "Invalid difficult level" << endl;
-    }
-}                    // end of setDifficulty
+void Sudoku::startFill() {
+    buildMasks();
+    nodes = 0;
+    SOLVER_STAT(stats.clear());
+    generating = false;
+    startSearch(FILL_GRID, searchOrder, 0, 0);
+}                      // end of startFill
 //==============================================================================
 
-//====checkSolution============================================================
-// Description: Checks if the puzzle has a unique solution
-// Return: true if the puzzle has a unique solution, false otherwise
+//====startSolve===============================================================
+// Description: Starts solving the board in slices, see runSearch. The board
+//              is left solved once it finishes with a result of 1
+//==============================================================================
+void Sudoku::startSolve() {
+    buildMasks();
+    nodes = 0;
+    SOLVER_STAT(stats.clear());
+    generating = false;
+    startSearch(FIND_SOLUTION, searchOrder, 0, 1);
+}                      // end of startSolve
 //==============================================================================
-bool Sudoku::checkSolution() {
-    int solutions = solutionCounter(0, 0);
-
-    if (solutions != 1) {
-        return false;
-    }
 
-    return true;
-}                    // end of checkSolution
+//====startCount===============================================================
+// Description: Starts counting solutions in slices, see runSearch
+// Parameters: limit - stop once this many are found (0 counts them all)
+//==============================================================================
+void Sudoku::startCount(int limit) {
+    buildMasks();
+    nodes = 0;
+    SOLVER_STAT(stats.clear());
+    generating = false;
+    startSearch(COUNT_SOLUTIONS, searchOrder, 0, limit);
+}                      // end of startCount
 //==============================================================================
 
-//====solutionCounter==========================================================
-// Description: Counts the number of solutions for the puzzle
-// Parameters: x - row, y - column
-// Return: number of solutions
+//====runSearch================================================================
+// Description: Runs a slice of the search begun by startGenerate,
+//              startFill, startSolve or startCount and returns, so it can
+//              share a thread with a UI or a request loop. Nothing else may
+//              change the board until it returns true
+// Parameters: steps - placements to make at most, deadline - stop once this
+//             time has passed
+// Return: true once the search has ended, see getSearchResult
 //==============================================================================
-int Sudoku::solutionCounter(int x, int y) {
-    int solutions = 0;
+bool Sudoku::runSearch(long long steps, chrono::steady_clock::time_point deadline) {
+    movesCounted = false;
+    SOLVER_STAT(auto sliceStart = chrono::steady_clock::now());
+    bool done = searchSteps(steps, deadline);
 
-    // base case: if puzzle is solvable
-    if (x == SIZE) {
-        return 1;   // found a solution
+    // a finished fill for startGenerate still needs its holes
+    if (done && generating) {
+        generating = false;
+        if (searchResult > 0) {
+            solvedBoard = board;
+            digCells(difficulty, chrono::steady_clock::time_point::max());
+            board.markGivens();
+        }
     }
 
-    // Calculate next cell position
-    int nextRow = (y == SIZE - 1) ? x + 1 : x;
-    int nextCol = (y + 1) % SIZE;
+    SOLVER_STAT(stats.calls = 1;
+                stats.maxNodes = stats.nodes;
+                stats.elapsed += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - sliceStart).count());
+    return done;
+}                      // end of runSearch
+//==============================================================================
+
+//====getSearchResult==========================================================
+// Description: Returns what the search begun by a start call found so far
+// Return: solutions counted, or 1 if a fill, solve or generate succeeded
+//==============================================================================
+int Sudoku::getSearchResult() {
+    return searchResult;
+}                      // end of getSearchResult
+//==============================================================================
+
+//====removeNums===============================================================
+// Description: Empties difficulty cells, keeping the solution unique. Stops
+//              early, with fewer cells removed, if every cell has been tried
+//==============================================================================
+void Sudoku::removeNums() {
+    SOLVER_STAT(beginStats());
+    digCells(difficulty, chrono::steady_clock::time_point::max());
+    SOLVER_STAT(endStats());
+}                         // end of removeNums
+//==============================================================================
 
-    // check if cell is filled
-    if (board[x][y] != 0) {
-        // Skip filled cells and move to the next
-        return solutionCounter(nextRow, nextCol);
+//====digCells==================================================================
+// Description: Empties cells in a shuffled order, each cell tried once,
+//              keeping every removal that leaves a unique solution. Trying
+//              every cell leaves a minimal puzzle: a clue that couldn't go
+//              earlier can't go once there are fewer clues
+// Parameters: limit - stop after this many removals, deadline - stop trying
+//             cells once this time has passed; the cancel flag stops it too,
+//             cells - how many cells of the shuffled order to try at most.
+//             triedCells is left holding how many were tried
+// Return: number of cells emptied
+//==============================================================================
+int Sudoku::digCells(int limit, chrono::steady_clock::time_point deadline, int cells) {
+    Propagator solver;
+    solver.setCancelFlag(cancel);
+    int order[81];
+    for (int i = 0; i < 81; i++) {
+        order[i] = i;
     }
+    rng.shuffle(order, 81);
 
-    // Try placing numbers 1-9
-    for (int i = 1; i <= SIZE; i++) {
-        if (checkValid(x, y, i)) {
-            board[x][y] = i;
+    buildMasks();
+    int removed = 0;
+    int i;
+    for (i = 0; i < cells && removed < limit; i++) {
+        if (cancelled() || chrono::steady_clock::now() >= deadline) {
+            break;
+        }
 
-            // accumlate solutions
-            solutions += solutionCounter(nextRow, nextCol);
+        int x = order[i] / SIZE;
+        int y = order[i] % SIZE;
+        int temp = board.get(x, y);
 
-            // reset cell to 0
-            board[x][y] = 0;
+        // remove number, put it back if the solution stops being unique
+        clearNum(x, y);
+        SOLVER_STAT(stats.uniqueChecks++);
+        if (uniqueWithout(x, y, temp, solver)) {
+            removed++;
+        } else {
+            placeNum(x, y, temp);
+            SOLVER_STAT(stats.uniqueRejected++);
         }
     }
 
-    return solutions;
-}                        // end of solutionCounter
+    triedCells = i;
+    return removed;
+}                         // end of digCells
 //==============================================================================
 
-//====removeNums===============================================================
-// Description: Removes numbers from the board
+//====forcedByUnits=============================================================
+// Description: Checks, from the row/column/box masks alone, whether a digit
+//              is a naked or hidden single in an empty cell
+// Parameters: x - row, y - column, bit - the digit's mask bit
+// Return: true if nothing else fits the cell or the digit fits nowhere else
+//         in one of its units
 //==============================================================================
-void Sudoku::removeNums() {
-    // random number 0-8
-    random_device rd;
-    mt19937 gen(rd());
-    uniform_int_distribution<> dis(0, SIZE - 1);
+bool Sudoku::forcedByUnits(int x, int y, unsigned short bit) {
+    if (candidates(x, y) == bit) {
+        return true;
+    }
 
-    // remove numbers from board
-    int removed = 0;
-    while (removed < difficulty) {
-        // generate random x and y coords
-        int x = dis(gen);
-        int y = dis(gen);
+    bool rowOnly = true;
+    bool colOnly = true;
+    bool boxOnly = true;
+    int br = x - x % 3;
+    int bc = y - y % 3;
 
-        // check if cell is empty
-        if (board[x][y] == 0) {
-            continue;
+    for (int k = 0; k < SIZE; k++) {
+        if (k != y && board.get(x, k) == 0 && (candidates(x, k) & bit)) {
+            rowOnly = false;
+        }
+        if (k != x && board.get(k, y) == 0 && (candidates(k, y) & bit)) {
+            colOnly = false;
         }
 
-        // remove number
-        int temp = board[x][y];
-        board[x][y] = 0;
-
-        // check if puzzle is still solvable
-        if (!checkSolution()) {
-            board[x][y] = temp;
-        } else {
-            removed++;
+        int r = br + k / 3;
+        int c = bc + k % 3;
+        if ((r != x || c != y) && board.get(r, c) == 0 && (candidates(r, c) & bit)) {
+            boxOnly = false;
         }
     }
-}                         // end of removeNums
+
+    return rowOnly || colOnly || boxOnly;
+}                         // end of forcedByUnits
+//==============================================================================
+
+//====uniqueWithout=============================================================
+// Description: Checks that a unique puzzle stays unique with one more cell
+//              emptied, cheapest proof first: a single on the masks, then
+//              full propagation, then a search for a solution that puts a
+//              different number in the cell. The masks must already have
+//              the cell cleared
+// Parameters: x - row, y - column, num - number the cell held,
+//             solver - scratch propagator reused between calls
+// Return: true if the puzzle still has exactly one solution
+//==============================================================================
+bool Sudoku::uniqueWithout(int x, int y, int num, Propagator &solver) {
+    if (forcedByUnits(x, y, 1 << (num - 1))) {
+        return true;
+    }
+
+    // the givens left still force the number back in
+    solver.load(board);
+    if (!solver.propagate() || solver.getValue(x, y) == num) {
+        return true;
+    }
+
+    // every other solution has something else in this cell
+    if (!solver.exclude(x, y, num)) {
+        return true;
+    }
+    return solver.count(1) == 0;
+}                         // end of uniqueWithout
 //==============================================================================
 
 //====printBoard===============================================================
@@ -255,7 +1712,7 @@ void Sudoku::removeNums() {
 void Sudoku::printBoard() {
     for (int i = 0; i < SIZE; i++) {
         for (int j = 0; j < SIZE; j++) {
-            cout << board[i][j] << " ";
+            cout << board.get(i, j) << " ";
 
             if ((j + 1) % 3 == 0) {
                 cout << "|";
@@ -274,18 +1731,149 @@ void Sudoku::printBoard() {
 // Parameters: x - row, y - column
 // Return: number at the specified cell
 //==============================================================================
-int Sudoku::getBoard(int x, int y) {
-    return board[x][y];
+int Sudoku::getBoard(int x, int y) const {
+    return board.get(x, y);
 }                      // end of getBoard
 //==============================================================================
 
+//====loadBoard================================================================
+// Description: Loads a puzzle from the 81-character line format, row by row,
+//              with '.' or '0' for empty cells. The masks are rebuilt, so
+//              fillBoard and solutionCounter can run on it directly
+// Parameters: puzzle - puzzle line; anything after the 81st cell is ignored
+// Return: true if the line was a puzzle, false otherwise (board unchanged)
+//==============================================================================
+bool Sudoku::loadBoard(const string &puzzle) {
+    if (puzzle.size() < 81) {
+        return false;
+    }
+
+    int cells[81];
+    for (int i = 0; i < 81; i++) {
+        char c = puzzle[i];
+        if (c == '.' || c == '0') {
+            cells[i] = 0;
+        } else if (c >= '1' && c <= '9') {
+            cells[i] = c - '0';
+        } else {
+            return false;
+        }
+    }
+
+    for (int i = 0; i < 81; i++) {
+        board.cells[i] = cells[i];
+    }
+    board.markGivens();
+    solvedBoard.clear();
+    clearNotes();
+    buildMasks();
+
+    return true;
+}                      // end of loadBoard
+//==============================================================================
+
+//====getBoardString===========================================================
+// Description: Returns the board in the 81-character line format
+// Return: board row by row, '.' for empty cells
+//==============================================================================
+string Sudoku::getBoardString() {
+    string line(81, '.');
+
+    for (int i = 0; i < SIZE; i++) {
+        for (int j = 0; j < SIZE; j++) {
+            if (board.get(i, j) != 0) {
+                line[i * SIZE + j] = '0' + board.get(i, j);
+            }
+        }
+    }
+
+    return line;
+}                      // end of getBoardString
+//==============================================================================
+
+//====snapshot================================================================
+// Description: Copies the board, givens included
+// Return: packed copy of the board
+//==============================================================================
+PackedBoard Sudoku::snapshot() const {
+    return board;
+}                      // end of snapshot
+//==============================================================================
+
+//====restore==================================================================
+// Description: Puts back a board taken with snapshot and rebuilds the masks
+// Parameters: saved - board to restore
+//==============================================================================
+void Sudoku::restore(const PackedBoard &saved) {
+    board = saved;
+    buildMasks();
+}                      // end of restore
+//==============================================================================
+
+//====getSolution==============================================================
+// Description: Copies the solved board of the current puzzle
+// Return: packed copy of the solution
+//==============================================================================
+PackedBoard Sudoku::getSolution() const {
+    return solvedBoard;
+}                      // end of getSolution
+//==============================================================================
+
+//====loadPuzzle===============================================================
+// Description: Takes over a puzzle generated by another solver, e.g. one
+//              from a PuzzlePool, as if generateBoard had just made it
+// Parameters: puzzle - clues marked as givens, solution - its solved board,
+//             puzzleSeed - seed it was generated from, id - its getPuzzleId
+//==============================================================================
+void Sudoku::loadPuzzle(const PackedBoard &puzzle, const PackedBoard &solution,
+                        uint64_t puzzleSeed, const string &id) {
+    board = puzzle;
+    solvedBoard = solution;
+    this->seed = puzzleSeed;
+    this->puzzleId = id;
+    clearNotes();
+    buildMasks();
+}                      // end of loadPuzzle
+//==============================================================================
+
 //====setBoard==========================================================
-// Description: Sets the board
+// Description: Sets the board, keeping the digit counts and the solver's
+//              masks in step
 // Parameters: x - row, y - column, num - number to set
 //==============================================================================
 void Sudoku::setBoard(int x, int y, int num) {
-    if (unsolvedBoard[x][y] == 0) {
-        board[x][y] = num;
+    if (board.isGiven(x, y)) {
+        return;
+    }
+
+    if (!movesCounted) {
+        countMoves();
+    }
+    if (board.get(x, y) != 0) {
+        tallyMove(x, y, board.get(x, y), -1);
+    }
+    if (num != 0) {
+        tallyMove(x, y, num, 1);
+    }
+    board.set(x, y, num);
+
+    // a mask bit stays set while any copy of the number is left in the unit
+    int box = boxIndex(x, y);
+    rowMask[x] = rowHas[x];
+    colMask[y] = colHas[y];
+    boxMask[box] = boxHas[box];
+
+    // a placed number is no longer a candidate anywhere it can see
+    if (num != 0) {
+        unsigned short keep = ~(1 << (num - 1));
+        int boxRow = (x / 3) * 3;
+        int boxCol = (y / 3) * 3;
+
+        for (int i = 0; i < SIZE; i++) {
+            notes[x * SIZE + i] &= keep;
+            notes[i * SIZE + y] &= keep;
+            notes[(boxRow + i / 3) * SIZE + boxCol + i % 3] &= keep;
+        }
     }
 }                   // end of setBoard
 //==============================================================================
@@ -294,27 +1882,110 @@ void Sudoku::setBoard(int x, int y, int num) {
 // Description: Checks if the board is full
 // Return: true if the board is full, false otherwise
 //==============================================================================
-bool Sudoku::isFull() {
-    for (int i = 0; i < SIZE; i++) {
-        for (int j = 0; j < SIZE; j++) {
-            if (board[i][j] == 0) {
-                return false;
-            }
-        }
+bool Sudoku::isFull() const {
+    if (!movesCounted) {
+        countMoves();
     }
 
-    return true;
+    return filledCells == SIZE * SIZE;
 }                        // end of isFull
 //==============================================================================
 
+//====hasConflicts============================================================
+// Description: Checks if any number appears twice in a row, column or box
+// Return: true if the board breaks a rule
+//==============================================================================
+bool Sudoku::hasConflicts() const {
+    if (!movesCounted) {
+        countMoves();
+    }
+
+    return clashes > 0;
+}                        // end of hasConflicts
+//==============================================================================
+
+//====isConflict==============================================================
+// Description: Checks if a cell's number is repeated in its row, column or
+//              box, so the screen can mark it
+// Parameters: x - row, y - column
+// Return: true if the cell clashes with another
+//==============================================================================
+bool Sudoku::isConflict(int x, int y) const {
+    int num = board.get(x, y);
+    if (num == 0) {
+        return false;
+    }
+    if (!movesCounted) {
+        countMoves();
+    }
+
+    return rowCount[x][num - 1] > 1 || colCount[y][num - 1] > 1 ||
+           boxCount[(x / 3) * 3 + y / 3][num - 1] > 1;
+}                        // end of isConflict
+//==============================================================================
+
+//====getCandidates===========================================================
+// Description: Returns the numbers an empty cell could still take: those
+//              not yet in its row, column or box. Three lookups, no scan
+// Parameters: x - row, y - column
+// Return: bit (num - 1) set for each candidate, 0 for a filled cell
+//==============================================================================
+unsigned short Sudoku::getCandidates(int x, int y) const {
+    if (board.get(x, y) != 0) {
+        return 0;
+    }
+    if (!movesCounted) {
+        countMoves();
+    }
+
+    return 0x1FF & ~(rowHas[x] | colHas[y] | boxHas[(x / 3) * 3 + y / 3]);
+}                        // end of getCandidates
+//==============================================================================
+
+//====getNotes================================================================
+// Description: Returns the pencil marks the player put in a cell. Placing a
+//              number takes it out of the marks of every cell it can see
+// Parameters: x - row, y - column
+// Return: bit (num - 1) set for each mark
+//==============================================================================
+unsigned short Sudoku::getNotes(int x, int y) const {
+    return notes[x * SIZE + y];
+}                        // end of getNotes
+//==============================================================================
+
+//====toggleNote==============================================================
+// Description: Adds or removes one of the player's pencil marks
+// Parameters: x - row, y - column, num - 1-9, or 0 to clear the cell's marks
+//==============================================================================
+void Sudoku::toggleNote(int x, int y, int num) {
+    if (num == 0) {
+        notes[x * SIZE + y] = 0;
+    } else {
+        notes[x * SIZE + y] ^= 1 << (num - 1);
+    }
+}                        // end of toggleNote
+//==============================================================================
+
+//====clearNotes==============================================================
+// Description: Removes every pencil mark; a new puzzle starts with none
+//==============================================================================
+void Sudoku::clearNotes() {
+    memset(notes, 0, sizeof(notes));
+}                        // end of clearNotes
+//==============================================================================
+
 //====isCorrect===============================================================
 // Description: Checks if the board is correct
 // Return: true if the board is correct, false otherwise
 //==============================================================================
 bool Sudoku::isCorrect() {
+    if (!isFull() || hasConflicts()) {
+        return false;
+    }
+
     for (int i = 0; i < SIZE; i++) {
         for (int j = 0; j < SIZE; j++) {
-            if (board[i][j] != solvedBoard[i][j]) {
+            if (board.get(i, j) != solvedBoard.get(i, j)) {
                 return false;
             }
         }
@@ -329,8 +2000,8 @@ bool Sudoku::isCorrect() {
 // Parameters: x - row, y - column
 // Return: true if the number is new, false otherwise
 //==============================================================================
-bool Sudoku::isNewNum(int x, int y) {
-    if (board[x][y] == unsolvedBoard[x][y]) {
+bool Sudoku::isNewNum(int x, int y) const {
+    if (board.isGiven(x, y) || board.get(x, y) == 0) {
         return false;
     }
 
@@ -342,11 +2013,9 @@ bool Sudoku::isNewNum(int x, int y) {
 // Description: Resets the board
 //==============================================================================
 void Sudoku::resetBoard() {
-    for (int i = 0; i < SIZE; i++) {
-        for (int j = 0; j < SIZE; j++) {
-            board[i][j] = unsolvedBoard[i][j];
-        }
-    }
+    board.resetToGivens();
+    clearNotes();
+    buildMasks();
 }
 //==============================================================================
 
@@ -1,33 +1,213 @@
 // Sudoku.h - header file
 
+#include <string>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+#include <chrono>
+#include <climits>
 using namespace std;
 
+// Bumped whenever a change makes the same seed generate a different puzzle;
+// part of every puzzle ID
+const int GENERATOR_VERSION = 1;
+
+// Enum for difficulty levels (number of cells removed)
+enum Difficulty {
+    EASY = 20,
+    MEDIUM = 30,
+    HARD = 40
+};
+
+// Order in which the solver picks the next empty cell
+enum SearchOrder {
+    ROW_MAJOR,          // left to right, top to bottom
+    MOST_CONSTRAINED    // empty cell with the fewest candidates (MRV)
+};
+
+// Engine used to solve and count solutions
+enum Backend {
+    BACKTRACKING,       // bitmask backtracking, see SearchOrder
+    DANCING_LINKS       // Algorithm X on the exact-cover matrix
+};
+
+// How generateBoard makes a new puzzle
+enum GenerationMode {
+    SEARCH,             // fill a random grid, then dig holes one at a time
+    TRANSFORM,          // random symmetry of a seed puzzle, see Seeds.h
+    STORE,              // random puzzle from a PuzzleStore, see setPuzzleStore
+    MINIMAL             // dig until no clue can go, see setMinimalGoal
+};
+
+// What the iterative search is after
+enum SearchGoal {
+    FILL_GRID,          // random numbers, stop at the first full board
+    FIND_SOLUTION,      // lowest numbers first, stop at the first solution
+    COUNT_SOLUTIONS     // lowest numbers first, count up to a limit
+};
+
+// One level of the iterative search: a cell and the numbers left to try
+struct SearchFrame {
+    unsigned char index;            // ROW_MAJOR: position in emptyCells
+    unsigned char x;
+    unsigned char y;
+    bool placed;                    // cell holds one of the frame's numbers
+    unsigned short open;            // candidates not tried yet
+    int next;                       // FILL_GRID: index in order to look from
+    int order[9];                   // FILL_GRID: numbers 1-9, shuffled
+    int before;                     // solutions found when it was placed
+};
+
 class Sudoku {
 private:
     const int SIZE = 9;
     int rows;
     int cols;
-    int board[9][9];
-    int solvedBoard[9][9];
-    int unsolvedBoard[9][9];
+    PackedBoard board;              // cells plus which of them are givens
+    PackedBoard solvedBoard;
     int difficulty;
+    int searchOrder;
+    int backend;
+    int generationMode;
+    const PuzzleStore *store;       // puzzles for STORE mode, not owned
+    int minRating;                  // SEARCH mode rating band, see Rater;
+    int maxRating;                  // maxRating 0 means no band
+    int targetClues;                // MINIMAL mode: good enough clue count
+    long long timeBudget;           // MINIMAL mode: microseconds per puzzle
+    Random rng;                     // every random choice comes from here
+    uint64_t seed;                  // seed of the last generated puzzle
+    string puzzleId;                // its ID, see getPuzzleId
+    int triedCells;                 // cells the last digCells tried
+    int minimalGrid;                // MINIMAL: grid the last puzzle came from
+    int minimalCells;               // MINIMAL: cells tried digging that grid
+    int replayGrid;                 // generateFromId: MINIMAL puzzle to
+    int replayCells;                // rebuild without the clock, -1 for none
+    bool propagation;               // run Propagator before/while guessing
+    PropagationStats propagationStats;
+    long long nodes;                // placements tried by the last search
+    SolverStats stats;              // counters of the last public call
+    int statsDepth;                 // public calls open, see beginStats
+    chrono::steady_clock::time_point statsStart;
+    SearchFrame searchStack[81];    // iterative search, see startSearch
+    int stackDepth;                 // frames in use
+    int searchGoal;
+    int searchCells;                // SearchOrder the search picks cells in
+    int searchLimit;                // COUNT_SOLUTIONS: 0 counts them all
+    int searchResult;               // solutions found so far
+    unsigned char emptyCells[81];   // ROW_MAJOR: cells to fill, in order
+    int emptyCount;
+    bool searchDone;
+    bool generating;                // dig once the fill ends, see startGenerate
+    const atomic<bool> *cancel;     // stop searching once set
+    unsigned short rowMask[9];      // bit (num - 1) set if num is in the row
+    unsigned short colMask[9];      // bit (num - 1) set if num is in the column
+    unsigned short boxMask[9];      // bit (num - 1) set if num is in the box
+    // Player's board, kept up to date by setBoard; searches and loads only
+    // mark it stale and the next query recounts, see countMoves
+    mutable unsigned char rowCount[9][9];   // [row][num - 1] copies of num
+    mutable unsigned char colCount[9][9];
+    mutable unsigned char boxCount[9][9];
+    mutable int filledCells;
+    mutable int clashes;            // (unit, num) pairs with num twice or more
+    mutable unsigned short rowHas[9];       // bit (num - 1) set while the
+    mutable unsigned short colHas[9];       // player's board has num in the
+    mutable unsigned short boxHas[9];       // unit, for getCandidates
+    mutable bool movesCounted;
+    unsigned short notes[81];       // player's pencil marks, bit (num - 1)
+
+    static PackedBoard seedPuzzles[3][SEEDS_PER_LEVEL];
+    static PackedBoard seedSolutions[3][SEEDS_PER_LEVEL];
+    static once_flag seedsLoaded;
+
+    int boxIndex(int x, int y);
+    bool buildMasks();
+    void placeNum(int x, int y, int num);
+    void clearNum(int x, int y);
+    void countMoves() const;
+    void tallyMove(int x, int y, int num, int change) const;
+    unsigned short candidates(int x, int y);
+    int mostConstrained(int &x, int &y, unsigned short &open);
+    void startSearch(int goal, int order, int start, int limit);
+    int descend(int next, int depth);
+    void finishSearch(bool keep);
+    bool searchSteps(long long steps = LLONG_MAX,
+                     chrono::steady_clock::time_point deadline = chrono::steady_clock::time_point::max());
+    void beginStats();
+    void endStats();
+    bool cancelled();
+    void splitBoard(int levels, vector<PackedBoard> &frontier);
+    vector<PackedBoard> splitSearch(int parts);
+    bool makeBoard();
+    void fillGrid();
+    void minimalBoard();
+    int digCells(int limit, chrono::steady_clock::time_point deadline, int cells = 81);
+    void replayMinimal();
+    string makePuzzleId();
+    static void loadSeeds();
+    int difficultyLevel();
+    void transformBoard();
+    bool storeBoard();
+    bool digToRating();
+    bool forcedByUnits(int x, int y, unsigned short bit);
+    bool uniqueWithout(int x, int y, int num, Propagator &solver);
 
 public:
     Sudoku();
     ~Sudoku();
-    void generateBoard();
+    bool generateBoard();
+    bool generateBoard(uint64_t puzzleSeed);
+    void setSeed(uint64_t streamSeed);
+    uint64_t getSeed();
+    string getPuzzleId();
+    bool generateFromId(const string &id);
     bool fillBoard(int x, int y);
     bool checkValid(int x, int y, int num);
     void randomNum(int arr[]);
     void setDifficulty(int num);
+    void setSearchOrder(int order);
+    void setBackend(int engine);
+    void setGenerationMode(int mode);
+    void setPuzzleStore(const PuzzleStore *puzzles);
+    void setRatingBand(int minScore, int maxScore);
+    void setMinimalGoal(int clues, long long budget);
+    void setPropagation(bool enabled);
+    PropagationStats getPropagationStats();
+    bool solveBoard();
+    bool solveBoardParallel(ThreadPool &pool);
+    int countSolutionsParallel(ThreadPool &pool, int limit = 0);
+    void setCancelFlag(const atomic<bool> *flag);
+    long long getNodeCount();
+    SolverStats getSolverStats();
     bool checkSolution();
-    int solutionCounter(int x, int y);
+    int solutionCounter(int x, int y, int limit = 0);
+    int countSolutions(int limit = 0);
+    void startGenerate();
+    void startFill();
+    void startSolve();
+    void startCount(int limit = 0);
+    bool runSearch(long long steps,
+                   chrono::steady_clock::time_point deadline = chrono::steady_clock::time_point::max());
+    int getSearchResult();
     void removeNums();
     void printBoard();
-    int getBoard(int x, int y);
+    int getBoard(int x, int y) const;
+    bool loadBoard(const string &puzzle);
+    string getBoardString();
+    PackedBoard snapshot() const;
+    void restore(const PackedBoard &saved);
+    PackedBoard getSolution() const;
+    void loadPuzzle(const PackedBoard &puzzle, const PackedBoard &solution, uint64_t puzzleSeed,
+                    const string &id);
     void setBoard(int x, int y, int num);
-    bool isFull();
+    bool isFull() const;
+    bool hasConflicts() const;
+    bool isConflict(int x, int y) const;
+    unsigned short getCandidates(int x, int y) const;
+    unsigned short getNotes(int x, int y) const;
+    void toggleNote(int x, int y, int num);
+    void clearNotes();
     bool isCorrect();
-    bool isNewNum(int x, int y);
+    bool isNewNum(int x, int y) const;
     void resetBoard();
 };
\ No newline at end of file
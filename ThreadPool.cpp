@@ -0,0 +1,153 @@
+// ThreadPool.cpp - implementation file
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include "ThreadPool.h"
+using namespace std;
+
+// Constructor
+ThreadPool::ThreadPool(int threads) {
+    if (threads < 1) {
+        threads = 1;
+    }
+
+    this->queued = 0;
+    this->pending = 0;
+    this->stopping = false;
+    this->next = 0;
+
+    for (int i = 0; i < threads; i++) {
+        queues.push_back(unique_ptr<WorkQueue>(new WorkQueue()));
+    }
+    for (int i = 0; i < threads; i++) {
+        workers.push_back(thread(&ThreadPool::run, this, i));
+    }
+}
+
+// Destructor: finishes queued work, then joins the workers
+ThreadPool::~ThreadPool() {
+    wait();
+
+    {
+        lock_guard<mutex> guard(stateLock);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for (thread &worker : workers) {
+        worker.join();
+    }
+}
+
+//====submit====================================================================
+// Description: Queues a task, spreading tasks round-robin over the workers
+// Parameters: task - work to run
+//==============================================================================
+void ThreadPool::submit(Task task) {
+    submitTo(next, task);
+    next = (next + 1) % size();
+}                         // end of submit
+//==============================================================================
+
+//====submitTo==================================================================
+// Description: Queues a task on one worker's queue; others may still steal it
+// Parameters: worker - queue to use, task - work to run
+//==============================================================================
+void ThreadPool::submitTo(int worker, Task task) {
+    // count the task before it can be seen: a worker that steals and
+    // finishes it needs stateLock to take it off the counts again
+    {
+        lock_guard<mutex> guard(stateLock);
+        queued++;
+        pending++;
+
+        lock_guard<mutex> queueGuard(queues[worker]->lock);
+        queues[worker]->tasks.push_back(task);
+    }
+    wake.notify_one();
+}                         // end of submitTo
+//==============================================================================
+
+//====popTask===================================================================
+// Description: Takes the newest task from a worker's own queue, or steals the
+//              oldest task from another worker's queue
+// Parameters: id - worker index, task - set to the task found
+// Return: true if a task was found, false otherwise
+//==============================================================================
+bool ThreadPool::popTask(int id, Task &task) {
+    int count = size();
+    bool found = false;
+
+    for (int i = 0; i < count && !found; i++) {
+        WorkQueue &queue = *queues[(id + i) % count];
+        lock_guard<mutex> guard(queue.lock);
+
+        if (queue.tasks.empty()) {
+            continue;
+        }
+
+        if (i == 0) {
+            task = queue.tasks.back();
+            queue.tasks.pop_back();
+        } else {
+            task = queue.tasks.front();
+            queue.tasks.pop_front();
+        }
+        found = true;
+    }
+
+    if (found) {
+        lock_guard<mutex> guard(stateLock);
+        queued--;
+    }
+
+    return found;
+}                         // end of popTask
+//==============================================================================
+
+//====run=======================================================================
+// Description: Worker loop: runs tasks until the pool is destroyed
+// Parameters: id - worker index
+//==============================================================================
+void ThreadPool::run(int id) {
+    while (true) {
+        Task task;
+
+        if (popTask(id, task)) {
+            task(id);
+
+            lock_guard<mutex> guard(stateLock);
+            if (--pending == 0) {
+                idle.notify_all();
+            }
+            continue;
+        }
+
+        // nothing to do: sleep until a task is queued or the pool stops
+        unique_lock<mutex> guard(stateLock);
+        wake.wait(guard, [this] { return stopping || queued > 0; });
+        if (stopping && queued == 0) {
+            return;
+        }
+    }
+}                         // end of run
+//==============================================================================
+
+//====wait======================================================================
+// Description: Blocks until every submitted task has finished
+//==============================================================================
+void ThreadPool::wait() {
+    unique_lock<mutex> guard(stateLock);
+    idle.wait(guard, [this] { return pending == 0; });
+}                         // end of wait
+//==============================================================================
+
+//====size======================================================================
+// Description: Returns the number of workers
+//==============================================================================
+int ThreadPool::size() {
+    return (int) queues.size();
+}                         // end of size
+//==============================================================================
+
+#endif
@@ -0,0 +1,43 @@
+// ThreadPool.h - header file
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <deque>
+#include <vector>
+#include <memory>
+using namespace std;
+
+// Task run by a worker; gets the worker's index so it can use that worker's
+// own state
+typedef function<void(int)> Task;
+
+class ThreadPool {
+private:
+    struct WorkQueue {
+        mutex lock;
+        deque<Task> tasks;
+    };
+
+    vector<thread> workers;
+    vector<unique_ptr<WorkQueue>> queues;   // one per worker
+    mutex stateLock;
+    condition_variable wake;                // tasks queued or stopping
+    condition_variable idle;                // pending dropped to zero
+    long long queued;                       // tasks sitting in queues
+    long long pending;                      // tasks submitted, not finished
+    bool stopping;
+    int next;
+
+    bool popTask(int id, Task &task);
+    void run(int id);
+
+public:
+    ThreadPool(int threads);
+    ~ThreadPool();
+    void submit(Task task);
+    void submitTo(int worker, Task task);
+    void wait();
+    int size();
+};
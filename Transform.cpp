@@ -0,0 +1,91 @@
+// Transform.cpp - implementation file
+#ifndef TRANSFORM_H
+#define TRANSFORM_H
+
+#include "PackedBoard.h"
+#include "Random.h"
+#include "Transform.h"
+#include <algorithm>
+using namespace std;
+
+// Constructor - starts as the identity
+Transform::Transform() {
+    this->turns = 0;
+    this->transpose = false;
+    for (int i = 0; i < 9; i++) {
+        rowMap[i] = i;
+        colMap[i] = i;
+    }
+    for (int d = 0; d < 10; d++) {
+        digitMap[d] = d;
+    }
+}
+
+//====shuffleLines==============================================================
+// Description: Builds a random line order that keeps bands together: the
+//              three bands are shuffled, then the three lines inside each
+// Parameters: map - receives the source line of each line, rng - random stream
+//==============================================================================
+void Transform::shuffleLines(int map[9], Random &rng) {
+    int bands[3] = {0, 1, 2};
+    rng.shuffle(bands, 3);
+
+    for (int b = 0; b < 3; b++) {
+        int lines[3] = {0, 1, 2};
+        rng.shuffle(lines, 3);
+        for (int i = 0; i < 3; i++) {
+            map[b * 3 + i] = bands[b] * 3 + lines[i];
+        }
+    }
+}                         // end of shuffleLines
+//==============================================================================
+
+//====randomize=================================================================
+// Description: Picks a new random symmetry: digit relabeling, band/stack
+//              order, row/column order within them, rotation and transpose
+// Parameters: rng - random stream
+//==============================================================================
+void Transform::randomize(Random &rng) {
+    shuffleLines(rowMap, rng);
+    shuffleLines(colMap, rng);
+
+    rng.shuffle(digitMap + 1, 9);
+
+    int pick = (int) rng.below(8);
+    turns = pick & 3;
+    transpose = pick >> 2;
+}                         // end of randomize
+//==============================================================================
+
+//====apply=====================================================================
+// Description: Writes the transformed board; givens move with their cells
+// Parameters: in - board to transform, out - receives the result (must not
+//             be in)
+//==============================================================================
+void Transform::apply(const PackedBoard &in, PackedBoard &out) const {
+    out.clear();
+
+    for (int r = 0; r < 9; r++) {
+        for (int c = 0; c < 9; c++) {
+            // walk back from the result cell to the cell it came from
+            int x = rowMap[r];
+            int y = colMap[c];
+            if (transpose) {
+                swap(x, y);
+            }
+            for (int t = 0; t < turns; t++) {
+                int old = x;
+                x = 8 - y;
+                y = old;
+            }
+
+            out.set(r, c, digitMap[in.get(x, y)]);
+            if (in.isGiven(x, y)) {
+                out.setGiven(r, c);
+            }
+        }
+    }
+}                         // end of apply
+//==============================================================================
+
+#endif // TRANSFORM_H
@@ -0,0 +1,22 @@
+// Transform.h - header file
+
+using namespace std;
+
+// A random symmetry of the sudoku grid. Applying it to a puzzle gives a
+// different-looking puzzle with the same number of solutions and the same
+// difficulty
+class Transform {
+private:
+    int turns;              // quarter turns clockwise, 0-3
+    bool transpose;         // swap rows and columns after turning
+    int rowMap[9];          // row r of the result comes from row rowMap[r]
+    int colMap[9];          // column c of the result comes from colMap[c]
+    int digitMap[10];       // digit d becomes digitMap[d]; 0 stays 0
+
+    void shuffleLines(int map[9], Random &rng);
+
+public:
+    Transform();
+    void randomize(Random &rng);
+    void apply(const PackedBoard &in, PackedBoard &out) const;
+};
@@ -12,11 +12,11 @@ const int GRID = 9;
 const int BOARD_SIZE = 540;
 const int CELL_SIZE = BOARD_SIZE / GRID;
 
-// Enum for difficulty levels
-enum Difficulty {
-    EASY = 20,
-    MEDIUM = 30,
-    HARD = 40
+// What the empty cells show in small digits
+enum PencilMarks {
+    PENCIL_OFF,
+    PENCIL_AUTO,        // numbers not yet in the cell's row, column or box
+    PENCIL_PLAYER       // the player's own marks, see Sudoku::toggleNote
 };
 
 // Struct for colors
@@ -29,6 +29,7 @@ struct Color {
     SDL_Color skyBlue = {134, 178, 214, 255};
     SDL_Color vibrantBlue = {0, 173, 239, 255};
     SDL_Color gray = {211, 211, 211, 255};
+    SDL_Color darkGray = {110, 110, 110, 255};
     // Add more colors as needed
 };
 
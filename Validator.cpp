@@ -0,0 +1,115 @@
+// Validator.cpp - implementation file
+//     Checks grids in the 81-character line format against the Sudoku rules
+//     without needing their solution or a Sudoku object
+#ifndef VALIDATOR_H
+#define VALIDATOR_H
+
+#include "Lanes.h"
+#include "Propagator.cpp"
+#include "Validator.h"
+using namespace std;
+
+//====validateGrid==============================================================
+// Description: Checks one grid: no number repeats in a row, column or box
+// Parameters: grid - 81 characters, '.' or '0' for empty cells,
+//             requireFull - also reject grids with empty cells
+// Return: true if the grid follows the rules, false otherwise (including
+//         characters that aren't cells)
+//==============================================================================
+bool validateGrid(const char *grid, bool requireFull) {
+    unsigned short rows[9] = {0};
+    unsigned short cols[9] = {0};
+    unsigned short boxes[9] = {0};
+
+    for (int cell = 0; cell < 81; cell++) {
+        char c = grid[cell];
+        if (c == '.' || c == '0') {
+            if (requireFull) {
+                return false;
+            }
+            continue;
+        }
+        if (c < '1' || c > '9') {
+            return false;
+        }
+
+        int x = cell / 9;
+        int y = cell % 9;
+        int b = (x / 3) * 3 + y / 3;
+        unsigned short bit = 1 << (c - '1');
+
+        if ((rows[x] | cols[y] | boxes[b]) & bit) {
+            return false;
+        }
+        rows[x] |= bit;
+        cols[y] |= bit;
+        boxes[b] |= bit;
+    }
+
+    return true;
+}                         // end of validateGrid
+//==============================================================================
+
+//====validateGrids=============================================================
+// Description: Checks many grids, LANE_WIDTH at a time: each group is
+//              transposed to one lane per grid, then every unit is checked
+//              for repeats in all lanes with a few vector operations
+// Parameters: grids - pointers to 81-character grids, count - how many,
+//             requireFull - also reject grids with empty cells,
+//             valid - receives the result for each grid
+// Return: number of valid grids
+//==============================================================================
+int validateGrids(const char *const grids[], int count, bool requireFull, bool valid[]) {
+    alignas(32) unsigned short bits[81][LANE_WIDTH];
+    alignas(32) unsigned short repeats[LANE_WIDTH];
+    bool bad[LANE_WIDTH];
+    int total = 0;
+
+    Propagator::buildTables();
+
+    for (int start = 0; start < count; start += LANE_WIDTH) {
+        int lanes = count - start < LANE_WIDTH ? count - start : LANE_WIDTH;
+
+        // transpose the group; unused lanes stay empty
+        for (int lane = 0; lane < LANE_WIDTH; lane++) {
+            const char *grid = lane < lanes ? grids[start + lane] : nullptr;
+            bad[lane] = false;
+
+            for (int cell = 0; cell < 81; cell++) {
+                char c = grid ? grid[cell] : '.';
+                if (c >= '1' && c <= '9') {
+                    bits[cell][lane] = 1 << (c - '1');
+                } else {
+                    bits[cell][lane] = 0;
+                    if ((c != '.' && c != '0') || (requireFull && grid)) {
+                        bad[lane] = true;
+                    }
+                }
+            }
+        }
+
+        // a number seen twice in any unit marks the lane
+        LaneVector repeated = laneZero();
+        for (int u = 0; u < 27; u++) {
+            LaneVector seen = laneZero();
+            for (int i = 0; i < 9; i++) {
+                LaneVector b = laneLoad(bits[Propagator::units[u][i]]);
+                repeated = laneOr(repeated, laneAnd(seen, b));
+                seen = laneOr(seen, b);
+            }
+        }
+        laneStore(repeats, repeated);
+
+        for (int lane = 0; lane < lanes; lane++) {
+            valid[start + lane] = !bad[lane] && repeats[lane] == 0;
+            if (valid[start + lane]) {
+                total++;
+            }
+        }
+    }
+
+    return total;
+}                         // end of validateGrids
+//==============================================================================
+
+#endif
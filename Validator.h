@@ -0,0 +1,6 @@
+// Validator.h - header file
+
+using namespace std;
+
+bool validateGrid(const char *grid, bool requireFull);
+int validateGrids(const char *const grids[], int count, bool requireFull, bool valid[]);
@@ -0,0 +1,859 @@
+/*
+================================================================================
+Sudoku Batch Solver
+    Headless solver: reads puzzles in the 81-character line format from a
+    file or stdin and streams one solution per line to stdout.
+================================================================================
+Usage: batch [options] [file]
+    -b, --backend NAME   backtrack (default) or dlx
+    -m, --mrv            branch on the most constrained cell
+    -p, --propagate      run singles/locked candidates before guessing
+    -t, --threads N      worker threads (default: one per core)
+    -s, --scaling        benchmark only: solve the input at 1, 2, 4, ... 16+
+                         threads and print puzzles/s for each
+    -x, --split          solve one puzzle at a time, splitting its search
+                         tree over all threads (lowest single-puzzle latency)
+    -k, --kernel         propagate 16 puzzles at a time in SIMD lanes and
+                         search only the ones that need it
+    -V, --validate       check grids against the rules instead of solving:
+                         prints "valid" or "invalid" per line
+    --partial            with -V, allow empty cells (default: grids must be
+                         full)
+    -n, --box RxC        solve N x N puzzles made of R x C boxes (2x2, 2x3,
+                         3x3, 3x4, 4x4, 5x5); cells are '1'-'9', then 'A'...
+    -d, --dedup          copy puzzles to the output, dropping any that is a
+                         symmetry (relabeling, row/column shuffle, rotation,
+                         transpose) of an earlier one
+    -c, --canonical      print each puzzle's minlex form instead of solving
+    -r, --rate           rate puzzles by the human techniques they need
+                         instead of solving: prints "score technique" per line
+    --build-db FILE      write the unique-solution puzzles of the input to a
+                         binary puzzle store for Sudoku's STORE generation
+                         mode, filed under the level of their rating;
+                         symmetric duplicates are dropped
+Output: the solved grid, "unsolvable" or "invalid" for each puzzle line, in
+        input order; "invalid" is a malformed line or givens that repeat in
+        a row, column or box. Blank lines and lines starting with '#' are
+        skipped.
+        Throughput and latency percentiles are reported on stderr at the end.
+================================================================================
+*/
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <unordered_set>
+#include "Sudoku.cpp"
+#include "Latency.cpp"
+#include "ThreadPool.cpp"
+#include "BatchKernel.cpp"
+#include "Validator.cpp"
+#include "BoxSudoku.h"
+#include "Canonical.cpp"
+using namespace std;
+
+const int BATCH = 256;          // puzzles per task
+const int READ_AHEAD = 16;      // batches per worker in flight ahead of the output
+
+// Command line settings
+struct Options {
+    int backend = BACKTRACKING;
+    bool mrv = false;
+    bool propagate = false;
+    int threads = 0;
+    bool scaling = false;
+    bool split = false;
+    bool kernel = false;
+    bool validate = false;
+    bool partial = false;
+    int boxRows = 0;                // 0: standard 9x9 engine
+    int boxCols = 0;
+    bool dedup = false;
+    bool canonical = false;
+    bool rate = false;
+    const char *storePath = nullptr;  // --build-db output
+    const char *path = nullptr;
+};
+
+// State owned by one worker thread; Sudoku keeps its boards as members, so
+// a solver can't be shared between threads
+struct Worker {
+    Sudoku solver;
+    BatchKernel kernel;
+    Rater rater;
+    bool useKernel = false;
+    bool validate = false;
+    bool rate = false;
+    bool requireFull = true;
+    LatencyHistogram latency;
+    SolverStats search = {};        // summed over every solveBoard call
+    long long unsolvable = 0;
+    long long invalid = 0;
+    long long rejected = 0;         // grids failing validation
+};
+
+//====usage=====================================================================
+// Description: Prints the command line help
+// Parameters: name - program name
+//==============================================================================
+void usage(const char *name) {
+    cerr << "Usage: " << name << " [-b backtrack|dlx] [-m] [-p] [-t threads] [-s] [-x] [-k] [-V [--partial]] [-n RxC] [-d] [-c] [-r] [--build-db out] [file]" << endl;
+}                             // end of usage
+//==============================================================================
+
+//====makeWorkers===============================================================
+// Description: Creates one configured solver per thread
+// Parameters: options - settings, count - number of workers
+// Return: the workers
+//==============================================================================
+vector<Worker> makeWorkers(const Options &options, int count) {
+    vector<Worker> workers(count);
+
+    for (Worker &worker : workers) {
+        worker.solver.setBackend(options.backend);
+        worker.solver.setPropagation(options.propagate);
+        if (options.mrv) {
+            worker.solver.setSearchOrder(MOST_CONSTRAINED);
+        }
+        worker.useKernel = options.kernel;
+        worker.validate = options.validate;
+        worker.rate = options.rate;
+        worker.requireFull = !options.partial;
+    }
+
+    return workers;
+}                             // end of makeWorkers
+//==============================================================================
+
+//====solveLanes================================================================
+// Description: Solves a group of puzzles together with the SIMD kernel; each
+//              puzzle is charged an equal share of the group's time
+// Parameters: worker - thread state, lines - puzzles, index - positions of
+//             the group's puzzles, count - group size, results - answers
+//==============================================================================
+void solveLanes(Worker &worker, const vector<string> &lines, const int index[], int count, vector<string> &results) {
+    string puzzles[BatchKernel::LANES];
+    string solutions[BatchKernel::LANES];
+    bool solved[BatchKernel::LANES];
+
+    for (int i = 0; i < count; i++) {
+        puzzles[i] = lines[index[i]];
+    }
+
+    auto begin = chrono::steady_clock::now();
+    worker.kernel.solve(puzzles, count, solutions, solved);
+    auto finish = chrono::steady_clock::now();
+    long long share = chrono::duration_cast<chrono::nanoseconds>(finish - begin).count() / count;
+
+    for (int i = 0; i < count; i++) {
+        if (solved[i]) {
+            worker.latency.add(share);
+            results[index[i]] = solutions[i];
+        } else {
+            results[index[i]] = "unsolvable";
+            worker.unsolvable++;
+        }
+    }
+}                             // end of solveLanes
+//==============================================================================
+
+//====validateLines=============================================================
+// Description: Checks a range of lines with the bulk validator
+// Parameters: worker - thread state, lines - grids, start/end - range,
+//             results - "valid" or "invalid" for each line
+//==============================================================================
+void validateLines(Worker &worker, const vector<string> &lines, int start, int end, vector<string> &results) {
+    const char *grids[BATCH] = {nullptr};
+    bool valid[BATCH];
+    int index[BATCH];
+    int count = 0;
+
+    for (int i = start; i < end; i++) {
+        if (lines[i].size() < 81) {
+            results[i] = "invalid";
+            worker.rejected++;
+        } else {
+            grids[count] = lines[i].c_str();
+            index[count++] = i;
+        }
+    }
+
+    auto begin = chrono::steady_clock::now();
+    validateGrids(grids, count, worker.requireFull, valid);
+    auto finish = chrono::steady_clock::now();
+    long long share = count ? chrono::duration_cast<chrono::nanoseconds>(finish - begin).count() / count : 0;
+
+    for (int i = 0; i < count; i++) {
+        results[index[i]] = valid[i] ? "valid" : "invalid";
+        worker.latency.add(share);
+        if (!valid[i]) {
+            worker.rejected++;
+        }
+    }
+}                             // end of validateLines
+//==============================================================================
+
+//====rateLines=================================================================
+// Description: Rates a range of lines with the human-technique rater
+// Parameters: worker - thread state, lines - puzzles, start/end - range,
+//             results - "score technique", "unsolvable" or "invalid"
+//==============================================================================
+void rateLines(Worker &worker, const vector<string> &lines, int start, int end, vector<string> &results) {
+    Rating rating;
+
+    for (int i = start; i < end; i++) {
+        if (!worker.solver.loadBoard(lines[i]) || worker.solver.hasConflicts()) {
+            results[i] = "invalid";
+            worker.invalid++;
+            continue;
+        }
+
+        auto begin = chrono::steady_clock::now();
+        bool rated = worker.rater.rate(worker.solver.snapshot(), rating);
+        auto finish = chrono::steady_clock::now();
+
+        if (rated) {
+            worker.latency.add(chrono::duration_cast<chrono::nanoseconds>(finish - begin).count());
+            results[i] = to_string(rating.score) + " " + Rater::techniqueName(rating.hardest);
+        } else {
+            results[i] = "unsolvable";
+            worker.unsolvable++;
+        }
+    }
+}                             // end of rateLines
+//==============================================================================
+
+//====solveLines================================================================
+// Description: Solves a range of lines with the worker's solver, or hands
+//              them to the validator, rater or SIMD kernel if so set up
+// Parameters: worker - thread state, lines - puzzles, start/end - range,
+//             results - answers, stored at each line's position
+//==============================================================================
+void solveLines(Worker &worker, const vector<string> &lines, int start, int end, vector<string> &results) {
+    int group[BatchKernel::LANES];
+    int grouped = 0;
+
+    if (worker.validate) {
+        validateLines(worker, lines, start, end, results);
+        return;
+    }
+    if (worker.rate) {
+        rateLines(worker, lines, start, end, results);
+        return;
+    }
+
+    for (int i = start; i < end; i++) {
+        if (!worker.solver.loadBoard(lines[i]) || worker.solver.hasConflicts()) {
+            results[i] = "invalid";
+            worker.invalid++;
+            continue;
+        }
+
+        // kernel mode: collect a full group of lanes first
+        if (worker.useKernel) {
+            group[grouped++] = i;
+            if (grouped == BatchKernel::LANES) {
+                solveLanes(worker, lines, group, grouped, results);
+                grouped = 0;
+            }
+            continue;
+        }
+
+        auto begin = chrono::steady_clock::now();
+        bool solved = worker.solver.solveBoard();
+        auto finish = chrono::steady_clock::now();
+        SOLVER_STAT(worker.search.add(worker.solver.getSolverStats()));
+
+        if (solved) {
+            worker.latency.add(chrono::duration_cast<chrono::nanoseconds>(finish - begin).count());
+            results[i] = worker.solver.getBoardString();
+        } else {
+            results[i] = "unsolvable";
+            worker.unsolvable++;
+        }
+    }
+
+    if (grouped > 0) {
+        solveLanes(worker, lines, group, grouped, results);
+    }
+}                             // end of solveLines
+//==============================================================================
+
+//====solveChunk================================================================
+// Description: Solves a block of puzzle lines on the pool, one task per
+//              BATCH lines, and stores each answer at its input position
+// Parameters: pool - worker threads, workers - per-thread state,
+//             lines - puzzles, results - answers, same size as lines
+//==============================================================================
+void solveChunk(ThreadPool &pool, vector<Worker> &workers, const vector<string> &lines, vector<string> &results) {
+    int count = (int) lines.size();
+
+    for (int start = 0; start < count; start += BATCH) {
+        int end = min(start + BATCH, count);
+
+        pool.submit([&workers, &lines, &results, start, end](int id) {
+            solveLines(workers[id], lines, start, end, results);
+        });
+    }
+
+    pool.wait();
+}                             // end of solveChunk
+//==============================================================================
+
+//====readPuzzle================================================================
+// Description: Reads the next puzzle line, skipping blanks and comments
+// Parameters: in - input stream, line - set to the line read
+// Return: true if a line was read, false at end of input
+//==============================================================================
+bool readPuzzle(istream &in, string &line) {
+    while (getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (!line.empty() && line[0] != '#') {
+            return true;
+        }
+    }
+
+    return false;
+}                             // end of readPuzzle
+//==============================================================================
+
+//====solveStream===============================================================
+// Description: Reads the input a BATCH of lines at a time and solves the
+//              batches on the pool, keeping READ_AHEAD of them per thread in
+//              flight. Each batch is written as soon as it and every batch
+//              before it are done, so output keeps input order but never
+//              waits on more than the oldest unfinished batch
+// Parameters: pool - worker threads, workers - per-thread state,
+//             in - input stream
+// Return: number of puzzle lines read
+//==============================================================================
+long long solveStream(ThreadPool &pool, vector<Worker> &workers, istream &in) {
+    struct PendingBatch {
+        vector<string> lines;
+        vector<string> results;
+        bool done = false;
+    };
+
+    size_t window = (size_t) pool.size() * READ_AHEAD;
+    deque<unique_ptr<PendingBatch>> pending;    // oldest first
+    deque<PendingBatch *> unclaimed;            // queued, no task on it yet
+    mutex batchLock;
+    condition_variable doneSignal;
+    string line;
+    bool more = true;
+    long long total = 0;
+
+    while (true) {
+        // read and queue the next batch while the window has room
+        if (more && pending.size() < window) {
+            unique_ptr<PendingBatch> batch(new PendingBatch());
+            while (batch->lines.size() < (size_t) BATCH && (more = readPuzzle(in, line))) {
+                batch->lines.push_back(line);
+            }
+
+            if (!batch->lines.empty()) {
+                total += batch->lines.size();
+                batch->results.assign(batch->lines.size(), string());
+                {
+                    lock_guard<mutex> guard(batchLock);
+                    unclaimed.push_back(batch.get());
+                }
+                pending.push_back(move(batch));
+
+                // the pool runs a worker's own tasks newest first, so each
+                // task takes the oldest batch rather than the one it was
+                // queued with; the output then never waits on a late start
+                pool.submit([&workers, &batchLock, &doneSignal, &unclaimed](int id) {
+                    PendingBatch *task;
+                    {
+                        lock_guard<mutex> guard(batchLock);
+                        task = unclaimed.front();
+                        unclaimed.pop_front();
+                    }
+
+                    solveLines(workers[id], task->lines, 0, (int) task->lines.size(), task->results);
+                    {
+                        lock_guard<mutex> guard(batchLock);
+                        task->done = true;
+                    }
+                    doneSignal.notify_one();
+                });
+            }
+        }
+
+        if (pending.empty()) {
+            break;
+        }
+
+        // write every finished batch at the front; only wait for the oldest
+        // one once there is nothing left to read or no room to read it
+        unique_lock<mutex> guard(batchLock);
+        if (!more || pending.size() >= window) {
+            doneSignal.wait(guard, [&pending] { return pending.front()->done; });
+        }
+        size_t ready = 0;
+        while (ready < pending.size() && pending[ready]->done) {
+            ready++;
+        }
+        guard.unlock();
+
+        // a finished batch is no longer touched by its worker
+        for (size_t i = 0; i < ready; i++) {
+            for (const string &result : pending.front()->results) {
+                cout << result << '\n';
+            }
+            pending.pop_front();
+        }
+        if (ready > 0) {
+            cout.flush();
+        }
+    }
+
+    return total;
+}                             // end of solveStream
+//==============================================================================
+
+//====report====================================================================
+// Description: Prints throughput and latency percentiles
+// Parameters: latency - per-puzzle solve times, seconds - wall time,
+//             unsolvable - puzzles with no solution, invalid - bad lines
+//==============================================================================
+void report(LatencyHistogram &latency, double seconds, long long unsolvable, long long invalid) {
+    long long solved = latency.getCount();
+
+    cerr << "puzzles:     " << solved << " (" << unsolvable << " unsolvable, "
+         << invalid << " invalid)" << endl;
+    cerr << "wall time:   " << seconds << " s" << endl;
+    cerr << "throughput:  " << (seconds > 0 ? solved / seconds : 0.0) << " puzzles/s" << endl;
+    cerr << "latency us:  mean " << latency.getMean() / 1000.0
+         << "  p50 " << latency.percentile(50) / 1000.0
+         << "  p90 " << latency.percentile(90) / 1000.0
+         << "  p99 " << latency.percentile(99) / 1000.0
+         << "  p99.9 " << latency.percentile(99.9) / 1000.0
+         << "  max " << latency.getMax() / 1000.0 << endl;
+}                             // end of report
+//==============================================================================
+
+//====reportSearch==============================================================
+// Description: Prints the summed search counters of the solver calls;
+//              nothing when they were compiled out or never counted
+// Parameters: search - counters summed over the calls
+//==============================================================================
+void reportSearch(const SolverStats &search) {
+    if (search.calls == 0) {
+        return;
+    }
+
+    cerr << "search:      " << search.nodes << " nodes (mean " << search.nodes / search.calls
+         << ", max " << search.maxNodes << " per puzzle), " << search.backtracks
+         << " dead ends, max depth " << search.maxDepth << endl;
+    if (search.validChecks > 0) {
+        cerr << "checks:      " << search.validChecks << " candidate lookups" << endl;
+    }
+}                             // end of reportSearch
+//==============================================================================
+
+//====runScaling================================================================
+// Description: Solves the same in-memory input at growing thread counts and
+//              prints puzzles/s and speedup over one thread for each
+// Parameters: options - settings, in - input stream
+//==============================================================================
+void runScaling(const Options &options, istream &in) {
+    vector<string> lines;
+    string line;
+    while (readPuzzle(in, line)) {
+        lines.push_back(line);
+    }
+    vector<string> results(lines.size());
+
+    int most = max(16, (int) thread::hardware_concurrency());
+    double base = 0;
+
+    cout << "threads  puzzles/s  speedup" << endl;
+    for (int threads = 1; threads <= most; threads *= 2) {
+        vector<Worker> workers = makeWorkers(options, threads);
+        ThreadPool pool(threads);
+
+        auto start = chrono::steady_clock::now();
+        solveChunk(pool, workers, lines, results);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        double rate = seconds > 0 ? lines.size() / seconds : 0.0;
+        if (threads == 1) {
+            base = rate;
+        }
+        cout << setw(7) << threads << "  " << setw(9) << (long long) rate
+             << "  " << fixed << setprecision(2) << (base > 0 ? rate / base : 0.0) << endl;
+        cout.unsetf(ios::fixed);
+    }
+}                             // end of runScaling
+//==============================================================================
+
+//====runSplit==================================================================
+// Description: Solves puzzles one at a time, each split over the whole pool,
+//              streaming every answer as soon as it is known
+// Parameters: options - settings, in - input stream
+//==============================================================================
+void runSplit(const Options &options, istream &in) {
+    vector<Worker> workers = makeWorkers(options, 1);
+    Worker &worker = workers[0];
+    ThreadPool pool(options.threads);
+    string line;
+    auto start = chrono::steady_clock::now();
+
+    while (readPuzzle(in, line)) {
+        if (!worker.solver.loadBoard(line) || worker.solver.hasConflicts()) {
+            cout << "invalid\n";
+            worker.invalid++;
+            continue;
+        }
+
+        auto begin = chrono::steady_clock::now();
+        bool solved = worker.solver.solveBoardParallel(pool);
+        auto finish = chrono::steady_clock::now();
+        SOLVER_STAT(worker.search.add(worker.solver.getSolverStats()));
+
+        if (solved) {
+            worker.latency.add(chrono::duration_cast<chrono::nanoseconds>(finish - begin).count());
+            cout << worker.solver.getBoardString() << '\n';
+        } else {
+            worker.unsolvable++;
+            cout << "unsolvable\n";
+        }
+        cout.flush();
+    }
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    report(worker.latency, seconds, worker.unsolvable, worker.invalid);
+    reportSearch(worker.search);
+}                             // end of runSplit
+//==============================================================================
+
+//====runCanonical==============================================================
+// Description: Streams puzzles through the canonicalizer, either printing
+//              each one's minlex form or dropping symmetric duplicates
+// Parameters: options - settings, in - input stream
+//==============================================================================
+void runCanonical(const Options &options, istream &in) {
+    Sudoku parser;
+    DedupIndex index;
+    PackedBoard canon;
+    string line;
+    long long total = 0;
+    long long invalid = 0;
+    auto start = chrono::steady_clock::now();
+
+    while (readPuzzle(in, line)) {
+        total++;
+        if (!parser.loadBoard(line) || parser.hasConflicts()) {
+            invalid++;
+            if (options.canonical) {
+                cout << "invalid\n";
+            }
+            continue;
+        }
+
+        if (options.canonical) {
+            canonicalForm(parser.snapshot(), canon);
+            parser.restore(canon);
+            cout << parser.getBoardString() << '\n';
+        } else if (index.insert(parser.snapshot())) {
+            cout << line << '\n';
+        }
+    }
+    cout.flush();
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cerr << "puzzles:     " << total << " (" << invalid << " invalid)" << endl;
+    if (options.dedup) {
+        cerr << "distinct:    " << index.size() << " (" << total - invalid - index.size()
+             << " duplicates, " << index.getCanonicalCount() << " minlex forms computed)" << endl;
+    }
+    cerr << "wall time:   " << seconds << " s" << endl;
+    cerr << "throughput:  " << (seconds > 0 ? total / seconds : 0.0) << " puzzles/s" << endl;
+}                             // end of runCanonical
+//==============================================================================
+
+//====runBuildStore=============================================================
+// Description: Solves and rates every input puzzle and writes the ones with
+//              a unique solution to a puzzle store, one per symmetry class
+// Parameters: options - settings, in - input stream
+// Return: exit status
+//==============================================================================
+int runBuildStore(const Options &options, istream &in) {
+    Sudoku solver;
+    solver.setBackend(DANCING_LINKS);
+    Rater rater;
+    Rating rating;
+    vector<PuzzleRecord> records;
+    unordered_set<uint64_t> seen;
+    PackedBoard puzzle;
+    PackedBoard canon;
+    string line;
+    long long total = 0;
+    long long rejected = 0;
+    long long duplicates = 0;
+    auto start = chrono::steady_clock::now();
+
+    while (readPuzzle(in, line)) {
+        total++;
+        if (!solver.loadBoard(line) || solver.countSolutions(2) != 1) {
+            rejected++;
+            continue;
+        }
+
+        puzzle = solver.snapshot();
+        canonicalForm(puzzle, canon);
+        uint64_t hash = canonicalHash(canon);
+        if (!seen.insert(hash).second) {
+            duplicates++;
+            continue;
+        }
+
+        solver.solveBoard();
+        rater.rate(puzzle, rating);
+
+        PuzzleRecord record;
+        packRecord(puzzle, solver.snapshot(), Rater::ratingLevel(rating.score), record);
+        record.canonHash = hash;
+        record.rating = rating.score;
+        records.push_back(record);
+    }
+
+    if (!writePuzzleStore(options.storePath, records)) {
+        cerr << "Cannot write " << options.storePath << endl;
+        return 1;
+    }
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    long long levels[STORE_LEVELS] = {0};
+    for (const PuzzleRecord &record : records) {
+        levels[record.level]++;
+    }
+
+    cerr << "puzzles:     " << total << " (" << rejected << " not unique, "
+         << duplicates << " duplicates)" << endl;
+    cerr << "stored:      " << records.size() << " (easy " << levels[0] << ", medium "
+         << levels[1] << ", hard " << levels[2] << ")" << endl;
+    cerr << "wall time:   " << seconds << " s" << endl;
+
+    return EXIT_SUCCESS;
+}                             // end of runBuildStore
+//==============================================================================
+
+//====solveBoxed================================================================
+// Description: Streams puzzles of one board size through the size-generic
+//              engine, one thread, one answer line per puzzle
+// Parameters: in - input stream
+//==============================================================================
+template <int BoxR, int BoxC>
+void solveBoxed(istream &in) {
+    BoxSudoku<BoxR, BoxC> solver;
+    LatencyHistogram latency;
+    long long unsolvable = 0;
+    long long invalid = 0;
+    string line;
+    auto start = chrono::steady_clock::now();
+
+    while (readPuzzle(in, line)) {
+        if (!solver.load(line)) {
+            cout << "invalid\n";
+            invalid++;
+            continue;
+        }
+
+        auto begin = chrono::steady_clock::now();
+        bool solved = solver.solve();
+        auto finish = chrono::steady_clock::now();
+
+        if (solved) {
+            latency.add(chrono::duration_cast<chrono::nanoseconds>(finish - begin).count());
+            cout << solver.toString() << '\n';
+        } else {
+            unsolvable++;
+            cout << "unsolvable\n";
+        }
+    }
+    cout.flush();
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    report(latency, seconds, unsolvable, invalid);
+}                             // end of solveBoxed
+//==============================================================================
+
+//====runBoxed==================================================================
+// Description: Picks the compiled engine for the requested box size
+// Parameters: options - settings, in - input stream
+// Return: exit code
+//==============================================================================
+int runBoxed(const Options &options, istream &in) {
+    int size = options.boxRows * 10 + options.boxCols;
+
+    switch (size) {
+        case 22:
+            solveBoxed<2, 2>(in);
+            break;
+        case 23:
+            solveBoxed<2, 3>(in);
+            break;
+        case 33:
+            solveBoxed<3, 3>(in);
+            break;
+        case 34:
+            solveBoxed<3, 4>(in);
+            break;
+        case 44:
+            solveBoxed<4, 4>(in);
+            break;
+        case 55:
+            solveBoxed<5, 5>(in);
+            break;
+        default:
+            cerr << "Unsupported box size " << options.boxRows << "x" << options.boxCols << endl;
+            return 1;
+    }
+
+    return EXIT_SUCCESS;
+}                             // end of runBoxed
+//==============================================================================
+
+//====main======================================================================
+//==============================================================================
+int main(int argc, char* argv[]) {
+    Options options;
+
+    // Parse options
+    for (int i = 1; i < argc; i++) {
+        if ((!strcmp(argv[i], "-b") || !strcmp(argv[i], "--backend")) && i + 1 < argc) {
+            string name = argv[++i];
+            if (name == "dlx") {
+                options.backend = DANCING_LINKS;
+            } else if (name == "backtrack") {
+                options.backend = BACKTRACKING;
+            } else {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (!strcmp(argv[i], "-m") || !strcmp(argv[i], "--mrv")) {
+            options.mrv = true;
+        } else if (!strcmp(argv[i], "-p") || !strcmp(argv[i], "--propagate")) {
+            options.propagate = true;
+        } else if ((!strcmp(argv[i], "-t") || !strcmp(argv[i], "--threads")) && i + 1 < argc) {
+            options.threads = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-s") || !strcmp(argv[i], "--scaling")) {
+            options.scaling = true;
+        } else if (!strcmp(argv[i], "-x") || !strcmp(argv[i], "--split")) {
+            options.split = true;
+        } else if (!strcmp(argv[i], "-k") || !strcmp(argv[i], "--kernel")) {
+            options.kernel = true;
+        } else if (!strcmp(argv[i], "-V") || !strcmp(argv[i], "--validate")) {
+            options.validate = true;
+        } else if (!strcmp(argv[i], "--partial")) {
+            options.partial = true;
+        } else if ((!strcmp(argv[i], "-n") || !strcmp(argv[i], "--box")) && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &options.boxRows, &options.boxCols) != 2) {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (!strcmp(argv[i], "-d") || !strcmp(argv[i], "--dedup")) {
+            options.dedup = true;
+        } else if (!strcmp(argv[i], "-c") || !strcmp(argv[i], "--canonical")) {
+            options.canonical = true;
+        } else if (!strcmp(argv[i], "-r") || !strcmp(argv[i], "--rate")) {
+            options.rate = true;
+        } else if (!strcmp(argv[i], "--build-db") && i + 1 < argc) {
+            options.storePath = argv[++i];
+        } else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+            usage(argv[0]);
+            return 1;
+        } else {
+            options.path = argv[i];
+        }
+    }
+    if (options.threads <= 0) {
+        options.threads = max(1, (int) thread::hardware_concurrency());
+    }
+
+    // Input: file if given, stdin otherwise
+    ifstream file;
+    if (options.path && strcmp(options.path, "-")) {
+        file.open(options.path);
+        if (!file) {
+            cerr << "Cannot open " << options.path << endl;
+            return 1;
+        }
+    }
+    istream &in = file.is_open() ? file : cin;
+    ios::sync_with_stdio(false);
+
+    if (options.scaling) {
+        runScaling(options, in);
+        return EXIT_SUCCESS;
+    }
+
+    if (options.split) {
+        runSplit(options, in);
+        return EXIT_SUCCESS;
+    }
+
+    if (options.boxRows) {
+        return runBoxed(options, in);
+    }
+
+    if (options.storePath) {
+        return runBuildStore(options, in);
+    }
+
+    if (options.dedup || options.canonical) {
+        runCanonical(options, in);
+        return EXIT_SUCCESS;
+    }
+
+    vector<Worker> workers = makeWorkers(options, options.threads);
+    ThreadPool pool(options.threads);
+    auto start = chrono::steady_clock::now();
+
+    // Solve in parallel, writing each batch in input order as it completes
+    long long total = solveStream(pool, workers, in);
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    // Merge the per-worker counters
+    LatencyHistogram latency;
+    SolverStats search;
+    search.clear();
+    long long unsolvable = 0;
+    long long invalid = 0;
+    long long rejected = 0;
+    for (Worker &worker : workers) {
+        latency.merge(worker.latency);
+        search.add(worker.search);
+        unsolvable += worker.unsolvable;
+        invalid += worker.invalid;
+        rejected += worker.rejected;
+    }
+
+    if (options.validate) {
+        cerr << "grids:       " << total << " (" << rejected << " invalid)" << endl;
+        cerr << "wall time:   " << seconds << " s" << endl;
+        cerr << "throughput:  " << (seconds > 0 ? total / seconds : 0.0) << " grids/s" << endl;
+    } else {
+        report(latency, seconds, unsolvable, invalid);
+        reportSearch(search);
+    }
+
+    return EXIT_SUCCESS;
+}                                     // end main
+//==============================================================================
@@ -0,0 +1,392 @@
+/*
+================================================================================
+Sudoku Benchmarks
+    Times the solver and generator with fixed seeds: grid filling, counting,
+    uniqueness checks, hole digging and full generation for each difficulty,
+    then solving the puzzle corpora in puzzles/ with each engine and finding
+    the minlex form of each corpus puzzle and of its solution grid.
+================================================================================
+Usage: bench [options]
+    -f, --filter TEXT    run only the benchmarks whose name contains TEXT
+    -o, --json FILE      write the results as JSON
+    -c, --compare FILE   compare medians against a JSON file written by -o
+    -t, --threshold PCT  slowdown of a median that counts as a regression
+                         (default 10)
+    -d, --corpus DIR     directory of puzzle corpora, one puzzle per line
+                         (default: puzzles)
+    -q, --quick          a tenth of the iterations
+Output: one line per benchmark with median and p99 time per operation and
+        operations per second. With -c, exits with status 1 if any median
+        regressed by more than the threshold.
+================================================================================
+*/
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <functional>
+#include <algorithm>
+#include <filesystem>
+#include "Sudoku.cpp"
+#include "Canonical.cpp"
+using namespace std;
+
+const uint64_t BENCH_SEED = 20240601;   // every benchmark starts from this
+const int COUNTER_PUZZLES = 200;        // HARD puzzles for the counting runs
+const string EMPTY_BOARD(81, '.');
+
+// Command line settings
+struct Options {
+    const char *filter = nullptr;
+    const char *jsonPath = nullptr;
+    const char *baselinePath = nullptr;
+    double threshold = 10.0;
+    string corpus = "puzzles";
+    int scale = 1;                  // iteration divisor
+};
+
+// Timing summary of one benchmark
+struct Result {
+    string name;
+    long long ops;
+    double median;                  // ns per operation
+    double p99;                     // ns per operation
+    double opsPerSec;
+};
+
+//====usage=====================================================================
+// Description: Prints the command line help
+// Parameters: name - program name
+//==============================================================================
+void usage(const char *name) {
+    cerr << "Usage: " << name << " [-f filter] [-o out.json] [-c baseline.json] [-t pct] [-d dir] [-q]" << endl;
+}                             // end of usage
+//==============================================================================
+
+//====measure===================================================================
+// Description: Times an operation one call at a time after a short warm-up.
+//              prepare runs before every call and is not timed
+// Parameters: name - benchmark name, ops - timed calls, prepare - untimed
+//             setup for call i, run - call i
+// Return: median, p99 and throughput of the timed calls
+//==============================================================================
+Result measure(const string &name, int ops, const function<void(int)> &prepare, const function<void(int)> &run) {
+    int warmup = max(1, ops / 10);
+    for (int i = 0; i < warmup; i++) {
+        prepare(i);
+        run(i);
+    }
+
+    vector<long long> samples(ops);
+    long long total = 0;
+    for (int i = 0; i < ops; i++) {
+        prepare(warmup + i);
+        auto begin = chrono::steady_clock::now();
+        run(warmup + i);
+        auto finish = chrono::steady_clock::now();
+        samples[i] = chrono::duration_cast<chrono::nanoseconds>(finish - begin).count();
+        total += samples[i];
+    }
+    sort(samples.begin(), samples.end());
+
+    Result result;
+    result.name = name;
+    result.ops = ops;
+    result.median = ops % 2 ? samples[ops / 2] : (samples[ops / 2 - 1] + samples[ops / 2]) / 2.0;
+    result.p99 = samples[min(ops - 1, (int) (ops * 0.99))];
+    result.opsPerSec = total > 0 ? ops * 1e9 / total : 0.0;
+    return result;
+}                             // end of measure
+//==============================================================================
+
+//====readCorpus================================================================
+// Description: Reads a puzzle file, skipping blank lines and comments
+// Parameters: path - corpus file
+// Return: the puzzle lines
+//==============================================================================
+vector<string> readCorpus(const string &path) {
+    vector<string> puzzles;
+    ifstream file(path);
+    string line;
+
+    while (getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (!line.empty() && line[0] != '#') {
+            puzzles.push_back(line);
+        }
+    }
+
+    return puzzles;
+}                             // end of readCorpus
+//==============================================================================
+
+//====readBaseline==============================================================
+// Description: Reads the medians out of a JSON file written by writeJson
+// Parameters: path - baseline file, medians - receives name -> median ns
+// Return: false if the file can't be opened
+//==============================================================================
+bool readBaseline(const char *path, map<string, double> &medians) {
+    ifstream file(path);
+    if (!file) {
+        return false;
+    }
+
+    // writeJson puts each benchmark on its own line
+    string line;
+    while (getline(file, line)) {
+        size_t name = line.find("\"name\": \"");
+        size_t median = line.find("\"median_ns\": ");
+        if (name == string::npos || median == string::npos) {
+            continue;
+        }
+
+        name += strlen("\"name\": \"");
+        size_t end = line.find('"', name);
+        medians[line.substr(name, end - name)] = atof(line.c_str() + median + strlen("\"median_ns\": "));
+    }
+
+    return true;
+}                             // end of readBaseline
+//==============================================================================
+
+//====writeJson=================================================================
+// Description: Writes the results as JSON, one benchmark per line
+// Parameters: path - output file, results - benchmark results
+// Return: false if the file can't be written
+//==============================================================================
+bool writeJson(const char *path, const vector<Result> &results) {
+    ofstream file(path);
+    if (!file) {
+        return false;
+    }
+
+    file << fixed << setprecision(1);
+    file << "{\n  \"generator_version\": " << GENERATOR_VERSION << ",\n";
+    file << "  \"seed\": " << BENCH_SEED << ",\n";
+    file << "  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result &r = results[i];
+        file << "    {\"name\": \"" << r.name << "\", \"ops\": " << r.ops
+             << ", \"median_ns\": " << r.median << ", \"p99_ns\": " << r.p99
+             << ", \"ops_per_sec\": " << r.opsPerSec << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    file << "  ]\n}\n";
+
+    return (bool) file;
+}                             // end of writeJson
+//==============================================================================
+
+//====makeHardPuzzles===========================================================
+// Description: Generates the fixed set of HARD puzzles the counting
+//              benchmarks run on
+// Return: puzzle lines
+//==============================================================================
+vector<string> makeHardPuzzles() {
+    Sudoku generator;
+    generator.setDifficulty(2);
+    generator.setSeed(BENCH_SEED);
+
+    vector<string> puzzles;
+    for (int i = 0; i < COUNTER_PUZZLES; i++) {
+        generator.generateBoard();
+        puzzles.push_back(generator.getBoardString());
+    }
+
+    return puzzles;
+}                             // end of makeHardPuzzles
+//==============================================================================
+
+//====main======================================================================
+//==============================================================================
+int main(int argc, char* argv[]) {
+    Options options;
+
+    // Parse options
+    for (int i = 1; i < argc; i++) {
+        if ((!strcmp(argv[i], "-f") || !strcmp(argv[i], "--filter")) && i + 1 < argc) {
+            options.filter = argv[++i];
+        } else if ((!strcmp(argv[i], "-o") || !strcmp(argv[i], "--json")) && i + 1 < argc) {
+            options.jsonPath = argv[++i];
+        } else if ((!strcmp(argv[i], "-c") || !strcmp(argv[i], "--compare")) && i + 1 < argc) {
+            options.baselinePath = argv[++i];
+        } else if ((!strcmp(argv[i], "-t") || !strcmp(argv[i], "--threshold")) && i + 1 < argc) {
+            options.threshold = atof(argv[++i]);
+        } else if ((!strcmp(argv[i], "-d") || !strcmp(argv[i], "--corpus")) && i + 1 < argc) {
+            options.corpus = argv[++i];
+        } else if (!strcmp(argv[i], "-q") || !strcmp(argv[i], "--quick")) {
+            options.scale = 10;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    const char *levels[3] = {"easy", "medium", "hard"};
+    vector<string> hardPuzzles = makeHardPuzzles();
+    vector<Result> results;
+    Sudoku s;
+
+    auto wanted = [&options](const string &name) {
+        return !options.filter || name.find(options.filter) != string::npos;
+    };
+    auto add = [&results](const Result &result) {
+        results.push_back(result);
+        cout << left << setw(32) << result.name << right << fixed << setprecision(1)
+             << "  median " << setw(10) << result.median / 1000.0 << " us"
+             << "  p99 " << setw(10) << result.p99 / 1000.0 << " us"
+             << "  " << setw(12) << result.opsPerSec << " ops/s" << endl;
+        cout.unsetf(ios::fixed);
+    };
+    auto none = [](int) {};
+
+    // Grid filling and the counting/uniqueness searches
+    if (wanted("fillBoard")) {
+        s.setSeed(BENCH_SEED);
+        add(measure("fillBoard", 2000 / options.scale,
+                    [&s](int) { s.loadBoard(EMPTY_BOARD); },
+                    [&s](int) { s.fillBoard(0, 0); }));
+    }
+    if (wanted("solutionCounter")) {
+        add(measure("solutionCounter", 1000 / options.scale,
+                    [&s, &hardPuzzles](int i) { s.loadBoard(hardPuzzles[i % COUNTER_PUZZLES]); },
+                    [&s](int) { s.solutionCounter(0, 0, 2); }));
+    }
+    if (wanted("checkSolution")) {
+        add(measure("checkSolution", 1000 / options.scale,
+                    [&s, &hardPuzzles](int i) { s.loadBoard(hardPuzzles[i % COUNTER_PUZZLES]); },
+                    [&s](int) { s.checkSolution(); }));
+    }
+
+    // Digging and full generation, per difficulty
+    for (int level = 0; level < 3; level++) {
+        string name = string("removeNums/") + levels[level];
+        if (wanted(name)) {
+            s.setDifficulty(level);
+            s.setSeed(BENCH_SEED);
+            add(measure(name, 500 / options.scale,
+                        [&s](int) { s.loadBoard(EMPTY_BOARD); s.fillBoard(0, 0); },
+                        [&s](int) { s.removeNums(); }));
+        }
+
+        name = string("generateBoard/") + levels[level];
+        if (wanted(name)) {
+            s.setDifficulty(level);
+            s.setSeed(BENCH_SEED);
+            add(measure(name, 500 / options.scale, none, [&s](int) { s.generateBoard(); }));
+        }
+    }
+
+    // Solving the checked-in corpora with each engine
+    vector<string> corpora;
+    if (filesystem::is_directory(options.corpus)) {
+        for (const auto &entry : filesystem::directory_iterator(options.corpus)) {
+            if (entry.path().extension() == ".txt") {
+                corpora.push_back(entry.path().string());
+            }
+        }
+    }
+    sort(corpora.begin(), corpora.end());
+
+    const char *engines[3] = {"dlx", "propagate", "mrv"};
+    for (const string &path : corpora) {
+        vector<string> puzzles = readCorpus(path);
+        if (puzzles.empty()) {
+            continue;
+        }
+
+        string corpus = filesystem::path(path).stem().string();
+        int ops = max((int) puzzles.size(), 500 / options.scale);
+
+        for (int engine = 0; engine < 3; engine++) {
+            string name = string("solve/") + engines[engine] + "/" + corpus;
+            if (!wanted(name)) {
+                continue;
+            }
+
+            Sudoku solver;
+            solver.setBackend(engine == 0 ? DANCING_LINKS : BACKTRACKING);
+            solver.setPropagation(engine == 1);
+            solver.setSearchOrder(MOST_CONSTRAINED);
+            add(measure(name, ops,
+                        [&solver, &puzzles](int i) { solver.loadBoard(puzzles[i % puzzles.size()]); },
+                        [&solver](int) { solver.solveBoard(); }));
+        }
+
+        // canonical forms of the puzzles and of their solutions; boards are
+        // visited in order, so the search doesn't run warm on one board
+        string name = "canonicalForm/" + corpus;
+        string gridName = "canonicalForm/grid/" + corpus;
+        if (!wanted(name) && !wanted(gridName)) {
+            continue;
+        }
+
+        Sudoku solver;
+        vector<PackedBoard> boards;
+        vector<PackedBoard> grids;
+        for (const string &puzzle : puzzles) {
+            if (solver.loadBoard(puzzle) && !solver.hasConflicts()) {
+                boards.push_back(solver.snapshot());
+                if (solver.solveBoard()) {
+                    grids.push_back(solver.snapshot());
+                }
+            }
+        }
+
+        PackedBoard canon;
+        if (wanted(name) && !boards.empty()) {
+            add(measure(name, max((int) boards.size(), 2000 / options.scale), none,
+                        [&boards, &canon](int i) { canonicalForm(boards[i % boards.size()], canon); }));
+        }
+        if (wanted(gridName) && !grids.empty()) {
+            add(measure(gridName, max((int) grids.size(), 500 / options.scale), none,
+                        [&grids, &canon](int i) { canonicalForm(grids[i % grids.size()], canon); }));
+        }
+    }
+
+    if (options.jsonPath && !writeJson(options.jsonPath, results)) {
+        cerr << "Cannot write " << options.jsonPath << endl;
+        return 1;
+    }
+
+    if (!options.baselinePath) {
+        return EXIT_SUCCESS;
+    }
+
+    // Compare medians with the baseline
+    map<string, double> baseline;
+    if (!readBaseline(options.baselinePath, baseline)) {
+        cerr << "Cannot open " << options.baselinePath << endl;
+        return 1;
+    }
+
+    int regressions = 0;
+    cout << endl << "compared with " << options.baselinePath << " (threshold "
+         << fixed << setprecision(1) << options.threshold << "%)" << endl;
+    cout.unsetf(ios::fixed);
+    for (const Result &result : results) {
+        auto found = baseline.find(result.name);
+        if (found == baseline.end() || found->second <= 0) {
+            cout << left << setw(32) << result.name << "  no baseline" << endl;
+            continue;
+        }
+
+        double change = (result.median / found->second - 1.0) * 100.0;
+        bool regressed = change > options.threshold;
+        regressions += regressed;
+        cout << left << setw(32) << result.name << right << fixed << setprecision(1)
+             << "  " << setw(7) << showpos << change << noshowpos << "%"
+             << (regressed ? "  REGRESSION" : "") << endl;
+        cout.unsetf(ios::fixed);
+    }
+
+    return regressions ? 1 : EXIT_SUCCESS;
+}                                     // end main
+//==============================================================================
@@ -13,6 +13,7 @@ Version: 12/27/2024
 #include <SDL2/SDL_ttf.h>
 #include "Graphics.cpp"
 #include "Sudoku.cpp"
+#include "PuzzlePool.cpp"
 using namespace std;
 
 //====main======================================================================
@@ -42,7 +43,15 @@ int main(int argc, char* argv[]) {
     }
     
     SDL_Window *window = SDL_CreateWindow("Sudoku Solver - Vinny Pham", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, WIDTH, HEIGHT, SDL_WINDOW_ALLOW_HIGHDPI);
-    SDL_Renderer *renderer = SDL_CreateRenderer(window, -1, 0);
+    SDL_Renderer *renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_TARGETTEXTURE);
+    if (renderer == nullptr) {
+        // the pencil marks fall back to one texture per digit
+        renderer = SDL_CreateRenderer(window, -1, 0);
+    }
+
+    // Puzzles for every difficulty are made in the background, so PLAY
+    // doesn't wait on the generator
+    PuzzlePool pool(2, 4);
 
     printStartScreen(renderer);
     createDifficultyButton(renderer, 0);
@@ -52,6 +61,9 @@ int main(int argc, char* argv[]) {
     bool running = true;
     bool leftClick = false;
     int numInput = -1;
+    bool noteInput = false;     // shift held: the number is a pencil mark
+    bool pencilKey = false;
+    int pencil = PENCIL_OFF;
     int startTime = 0;
     int elapsedTime = 0;
     int pausedTime = 0;
@@ -69,6 +81,8 @@ int main(int argc, char* argv[]) {
             
             // Get number input
             } else if (event.type == SDL_KEYDOWN) {
+                noteInput = (event.key.keysym.mod & KMOD_SHIFT) != 0;
+
                 switch (event.key.keysym.sym) {
                     case SDLK_1:
                         numInput = 1;
@@ -100,6 +114,9 @@ int main(int argc, char* argv[]) {
                     case SDLK_BACKSPACE:
                         numInput = 0;
                         break;
+                    case SDLK_p:
+                        pencilKey = true;
+                        break;
                     default:
                         break;
                 }
@@ -148,8 +165,8 @@ int main(int argc, char* argv[]) {
                 if (x >= 280 && x <= 515 && y >= 325 && y <= 390) {
                     startScreen = false;
                     playScreen = true;
-                    game.generateBoard();
-                    printGameScreen(renderer, game);
+                    pool.take(game, difficulty);
+                    printGameScreen(renderer, game, pencil);
                 }
                 
                 // checks difficulty button
@@ -178,7 +195,7 @@ int main(int argc, char* argv[]) {
             // Event handle
             if (leftClick) {
                 SDL_GetMouseState(&x, &y);
-                printGameScreen(renderer, game);
+                printGameScreen(renderer, game, pencil);
                 cout << x << " " << y << endl;
 
                 // Select cell
@@ -187,13 +204,15 @@ int main(int argc, char* argv[]) {
                 // Reset board
                 if (x >= 125 && x <= 290 && y >= 700 && y <= 750) {
                     game.resetBoard();
-                    printGameScreen(renderer, game);
+                    printGameScreen(renderer, game, pencil);
                 }
 
                 // Submit button
                 if (x >= 515 && x <= 675 && y >= 700 && y <= 750) {
                     if (!game.isFull()) {
                         renderText(renderer, "Board isn't filled", 40, color.black, 50);
+                    } else if (game.hasConflicts()) {
+                        renderText(renderer, "Board has conflicts", 40, color.black, 50);
                     } else if (!game.isCorrect()) {
                         renderText(renderer, "Board isn't correct", 40, color.black, 50);
                     } else {
@@ -211,12 +230,22 @@ int main(int argc, char* argv[]) {
                 pausedTime = SDL_GetTicks();
             }
             
-            // Change number
+            // Cycle pencil marks: off, automatic, player's own
+            if (pencilKey) {
+                pencil = (pencil + 1) % 3;
+                printGameScreen(renderer, game, pencil);
+            }
+
+            // Change number, or with shift a pencil mark
             if (index != -1 && numInput != -1) {
                 int row = index / 9;
                 int col = index % 9;
-                game.setBoard(row, col, numInput);
-                printGameScreen(renderer, game);
+                if (noteInput) {
+                    game.toggleNote(row, col, numInput);
+                } else {
+                    game.setBoard(row, col, numInput);
+                }
+                printGameScreen(renderer, game, pencil);
 
                 numInput = -1;
                 index = -1;
@@ -230,9 +259,12 @@ int main(int argc, char* argv[]) {
 
         // Reset variables
         leftClick = false;
+        pencilKey = false;
     }
     
     // Clean up
+    pool.stop();
+    freeMiniDigits();
     SDL_DestroyWindow(window);
     SDL_DestroyRenderer(renderer);
     SDL_Quit();